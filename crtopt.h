@@ -16,6 +16,9 @@ size_t opt_u64toa_hex(uint64_t value, char* dst, bool useUpperCase = true);
 // dtoaŻ
 size_t opt_dtoa(double value, char* buffer);
 
+// atodŻضȡַǺϷֵʱ0
+size_t opt_atod(const char* str, size_t len, double* value);
+
 //////////////////////////////////////////////////////////////////////////
 size_t opt_stristr(const char* str, size_t strLeng, const char* find, size_t findLeng);
 
@@ -1,21 +1,20 @@
 #include "sfjson.h"
 
+// counts every allocation made through sfJsonSetAllocator
+static size_t _gAllocs = 0;
+static void* countMalloc(size_t size, void*) { ++ _gAllocs; return malloc(size); }
+static void* countRealloc(void* ptr, size_t size, void*) { ++ _gAllocs; return realloc(ptr, size); }
+static void countFree(void* ptr, void*) { free(ptr); }
+
 // simple test
 struct Test {
 	Test()
 	{
-		FILE* fp = fopen("d://1.json", "rb");
-		fseek(fp, 0L, SEEK_END);
-		size_t s = ftell(fp);
-		fseek(fp, 0L, SEEK_SET);
-
-		char* mem = (char*)malloc(s + 1);
-		fread(mem, 1, s, fp);
-		fclose(fp);
-
 		std::string str;
-		sfNode* n = sfJsonDecode(mem, s);
+		sfNode* n = sfJsonDecodeFile("d://1.json");
 		//n->printTo(str);
+		if (n)
+			n->destroy();
 
 		n = sfJsonCreate(true);
 		n->add(
@@ -28,13 +27,79 @@ struct Test {
 
 		n->printTo(str);
 
-		fp = fopen("d://2.json", "wb");
+		FILE* fp = fopen("d://2.json", "wb");
 		fwrite(str.c_str(), 1, str.length(), fp);
 		fclose(fp);
 
-		free(mem);
-
 		int l = 0;
+
+		n->destroy();
+
+		// appendNamed / createParentObject after buildIndex must keep the name index complete
+		str = "{";
+		for (int i = 0; i < 1000; ++ i)
+		{
+			char szBuf[32];
+			sprintf(szBuf, "%s\"k%d\":%d", i ? "," : "", i, i);
+			str += szBuf;
+		}
+		str += "}";
+
+		n = sfJsonDecode(str, false, kJsonDecodeIndex);
+		assert(n && n->childIndex);
+		for (int i = 1000; i < 3000; ++ i)
+		{
+			char szBuf[32];
+			sprintf(szBuf, "k%d", i);
+			n->appendNamed(szBuf, i);
+		}
+		n->add(n->createValue((int64_t)3001)->createParentObject("k3001"), "wrap");
+		for (int i = 0; i < 3000; ++ i)
+		{
+			char szBuf[32];
+			sprintf(szBuf, "k%d", i);
+			sfNode* c = n->find(szBuf);
+			assert(c && c->ival == i);
+		}
+		assert(n->find("wrap") && n->find("wrap")->find("k3001"));
+		n->destroy();
+
+		// sfJsonParser must not allocate once warmed up, whatever the decode flags
+		str = "[";
+		for (int i = 0; i < 2000; ++ i)
+		{
+			char szBuf[64];
+			str += i ? ",{" : "{";
+			for (int k = 0; k < 20; ++ k)
+			{
+				sprintf(szBuf, "%s\"f%d\":%d", k ? "," : "", k, i * k);
+				str += szBuf;
+			}
+			str += ",\"name\":\"record\",\"tags\":[1,2,3]}";
+		}
+		str += "]";
+
+		sfJsonAllocator oldAlloc = sfjson::allocator();
+		sfJsonAllocator countAlloc = { countMalloc, countRealloc, countFree, NULL };
+		sfJsonSetAllocator(countAlloc);
+
+		const uint32_t allFlags[] = { 0, kJsonDecodeStructural, kJsonDecodeIndex, kJsonDecodeStructural | kJsonDecodeIndex };
+		for (size_t f = 0; f < sizeof(allFlags) / sizeof(allFlags[0]); ++ f)
+		{
+			sfJsonParser parser;
+			for (int r = 0; r < 3; ++ r)
+				assert(parser.decode(str.c_str(), str.length(), true, allFlags[f]));
+
+			_gAllocs = 0;
+			for (int r = 0; r < 5; ++ r)
+			{
+				n = parser.decode(str.c_str(), str.length(), true, allFlags[f]);
+				assert(n && n->childCount == 2000 && n->index(1999)->find("f19")->ival == 1999 * 19);
+			}
+			assert(_gAllocs == 0);
+		}
+
+		sfJsonSetAllocator(oldAlloc);
 	}
 } _gTest;
 
@@ -3,51 +3,98 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <assert.h>
 
 #include <string>
 #include <algorithm>
+#include <iterator>
+#include <new>
 
 #ifdef _WINDOWS
+#	include <windows.h>
+#	include <io.h>
 #	undef min
 #	undef max
 #	include <stdint.h>
 #else
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <sys/uio.h>
+#	include <limits.h>
+#	include <errno.h>
+#endif
+
+// x86/x64ʹSSE2AVX2ʱͬʱʹAVX2ַɨ
+#if defined(i386) || defined(__amd64) || defined(_M_IX86) || defined(_M_X64)
+#	define SFJ_SSE2_OPT
+#	include <emmintrin.h>
+#	ifdef __AVX2__
+#		define SFJ_AVX2_OPT
+#		include <immintrin.h>
+#	endif
+#	if defined(__PCLMUL__) && defined(__amd64)
+#		define SFJ_CLMUL_OPT
+#		include <wmmintrin.h>
+#	endif
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#	endif
+#endif
+
+// ֧C++11ʱṩҪԭӲ̵߳Ĺܣֱн롢н룩
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1700)
+#	define SFJ_CXX11
+#	include <atomic>
+#	include <thread>
+#	include <mutex>
+#	include <condition_variable>
+#endif
+
+// 쳣ʱ߳ʧ׳쳣ڲнڲ
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#	define SFJ_EXCEPTIONS
+#endif
 
+// ԤȡһҪʵĽڵ
+#if defined(__GNUC__)
+#	define SFJ_PREFETCH(p)	__builtin_prefetch(p)
+#elif defined(SFJ_SSE2_OPT)
+#	define SFJ_PREFETCH(p)	_mm_prefetch((const char*)(p), _MM_HINT_T0)
+#else
+#	define SFJ_PREFETCH(p)
 #endif
 
 // ʱĳʼڴС
 #define SFJ_ENCODE_INIT_MEMSIZE	4096
+// ʱջϱĲǶ׸ʱΪӶϷ
+#define SFJ_ENCODE_STACK_SIZE	64
 // JSONĽֵᱻ
 #define SFJ_MAX_PARSE_LEVEL		200
-
+// нʱÿ߳ٴôֽڣĵ̫Сʱ߳
+#define SFJ_PARALLEL_MIN_CHUNK	(256 * 1024)
+// нʱÿ߳ÿһֽһɲص֮ſʼһ
+#define SFJ_LINES_BATCH_SIZE	(1024 * 1024)
+// ڵصڴ4KBʼÿμӱֱСΪֹʱᰴԴ볤ԤһڴĴС
+#define SFJ_NODES_BLOCK_MAX		(4 * 1024 * 1024)
+// SFJ_USE_HUGEPAGESʱڵ2MBϵڴʹ͸ҳLinuxĵʱTLBȱʧ
+// #define SFJ_USE_HUGEPAGES
+// ӽڵﵽֵfind/indexʱΪֵĹϣΪӽڵָ
+#define SFJ_FIND_INDEX_MIN		16
+
+// հֵַĲɼַʱ
 #define SFJ_SKIP_WHITES()\
-	while(pReadPos != m_pMemEnd) {\
-		uint8_t ch = pReadPos[0];\
-		if (ch > 32)\
-			break;\
-		if (json_invisibles_allowed[ch] != 1) {\
-			m_iErr = kErrorSymbol;\
-			return 0;\
-		}\
-		pReadPos ++;\
-	}\
-	if (pReadPos >= m_pMemEnd) return 0;
+	pReadPos = skipWhites(pReadPos);\
+	if (!pReadPos || pReadPos >= m_pMemEnd) return 0;
 
+// dstֻǿɼţdstհһ
 #define SFJ_SKIP_TO(dst)\
 	m_pLastPos = pReadPos;\
-	while(pReadPos != m_pMemEnd) {\
-		uint8_t ch = pReadPos[0];\
-		if (ch > 32 || ch == dst)\
-			break;\
-		if (json_invisibles_allowed[ch] != 1) {\
-			m_iErr = kErrorSymbol;\
-			return 0;\
-		}\
-		pReadPos ++;\
-	}\
-	if (pReadPos >= m_pMemEnd) return 0;
+	pReadPos = skipWhites(pReadPos);\
+	if (!pReadPos || pReadPos >= m_pMemEnd) return 0;
 
 
 enum sfNodeValueType
@@ -67,7 +114,17 @@ enum sfJsonFlags {
 	kJsonSimpleEscape = 2,
 };
 
+// ѡ
+enum sfJsonDecodeFlags {
+	kJsonDecodeStructural = 1,		// ׶ν룺SIMDṹٰڵ
+	kJsonDecodeIndex = 2,			// ɺsfNode::buildIndexΪĶ齨
+};
+
 class sfNode;
+class sfJsonCursor;
+class sfJsonLazyDoc;
+class sfJsonLines;
+class sfJsonParser;
 
 // JsonNode
 /*
@@ -78,7 +135,8 @@ class sfNode;
  *   sfNode* root = sfJsonDecode(jsonString, stringLength);
  *   puts(root->find("name"));
  *   puts(root->index(0)->strval);
- *   ƼʹindexΪÿζҪͷʼǸݴĵҪдchildʼʹnextԱ
+ *   ˳ʱƼʹõfor (sfNode* n : *root) { ... }дchildʼʹnextԱ
+ *   buildIndex߽ʱʹkJsonDecodeIndexӽڵﵽSFJ_FIND_INDEX_MINindexǳʱ䣬findǹϣ
  *
  * encodeʾ
  *   sfNode* root = sfJsonCreate(true);
@@ -111,10 +169,11 @@ public:
 		int32_t		i32val;
 		double		dval;
 		char		*strval;
+		sfNode		**childIndex;					// 󣺰ֵĹϣѰַ飺˳ӽڵָûнʱΪNULL
 	};
 
 	uint32_t		nameLength;
-	uint32_t		valLength;						// ʱ-1ʾֵַʾʱԴֵַַ
+	uint32_t		valLength;						// ʱ-1ʾֵַʾʱԴֵַַ齨ʱΪĲ
 
 	uint32_t		childCount;
 	uint32_t		nodeType;
@@ -125,6 +184,62 @@ public:
 
 namespace sfjson {
 
+	// ڴӿڣеڴ棨JFileڵءַ塢ֱȣͨ䣬sfJsonSetAllocator滻
+	// еĴ벻fnMalloc/fnReallocNULLʱmemAlloc/memReallocoperator newһ׳std::bad_allocûд쳣ʱabort
+	// Ҫڴʱýʧܶ׳쳣ģӦʹsfJsonDecodeArenakErrorNoMemory
+	struct Allocator
+	{
+		void* (*fnMalloc)(size_t size, void* user);
+		void* (*fnRealloc)(void* ptr, size_t size, void* user);
+		void (*fnFree)(void* ptr, void* user);
+		void* user;
+	};
+
+	static void* defaultMalloc(size_t size, void*) { return ::malloc(size); }
+	static void* defaultRealloc(void* ptr, size_t size, void*) { return ::realloc(ptr, size); }
+	static void defaultFree(void* ptr, void*) { ::free(ptr); }
+
+	// staticinlineаļı뵥Ԫͬһ
+	inline Allocator& allocator()
+	{
+		static Allocator a = { defaultMalloc, defaultRealloc, defaultFree, NULL };
+		return a;
+	}
+
+	static void allocFailed()
+	{
+#ifdef SFJ_EXCEPTIONS
+		throw std::bad_alloc();
+#else
+		abort();
+#endif
+	}
+
+	static inline void* memAlloc(size_t size)
+	{
+		Allocator& a = allocator();
+		void* p = a.fnMalloc(size, a.user);
+		if (!p && size)
+			allocFailed();
+		return p;
+	}
+	static inline void* memRealloc(void* ptr, size_t size)
+	{
+		Allocator& a = allocator();
+		void* p = a.fnRealloc(ptr, size, a.user);
+		if (!p && size)
+			allocFailed();
+		return p;
+	}
+	static inline void memFree(void* ptr)
+	{
+		if (ptr)
+		{
+			Allocator& a = allocator();
+			a.fnFree(ptr, a.user);
+		}
+	}
+
 	// ASCIIַԱ1ʾţ2ʾСдĸ3ʾ֣4ʾСķ
 	// 1 = 0~9
 	// 2 = + - .
@@ -151,12 +266,10 @@ namespace sfjson {
 	static uint8_t json_escape_chars[256] = { 0 };
 	static uint8_t json_unescape_chars[256] = { 0 };
 
-	static void initJsonEscapeChars()
+	static bool fillJsonEscapeChars()
 	{
-		if (json_escape_chars['\\'])
-			return ;
-
 		json_allends_allowed[','] = json_allends_allowed['}'] = json_allends_allowed[']'] = json_allends_allowed[' '] = 1;
+		json_allends_allowed['\t'] = json_allends_allowed['\r'] = json_allends_allowed['\n'] = 1;
 
 		json_escape_chars['\\'] = 1;
 		//json_escape_chars['/'] = 1;
@@ -183,6 +296,248 @@ namespace sfjson {
 		json_unescape_chars['\\'] = '\\';
 		json_unescape_chars['\''] = '\'';
 		json_unescape_chars['"'] = '"';
+
+		return true;
+	}
+	// ֲֻ̬ʼһΣC++11̰߳ȫģ߳ͬʱʱõֻһı
+	static inline void initJsonEscapeChars()
+	{
+		static bool bInited = fillJsonEscapeChars();
+		(void)bInited;
+	}
+
+	// maskλ1ڵλãmaskΪ0
+	static inline uint32_t bitScan32(uint32_t mask)
+	{
+#ifdef _MSC_VER
+		unsigned long idx;
+		_BitScanForward(&idx, mask);
+		return idx;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+	static inline uint32_t bitScan64(uint64_t mask)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long idx;
+		_BitScanForward64(&idx, mask);
+		return idx;
+#elif defined(_MSC_VER)
+		return (uint32_t)mask ? bitScan32((uint32_t)mask) : 32 + bitScan32((uint32_t)(mask >> 32));
+#else
+		return __builtin_ctzll(mask);
+#endif
+	}
+	static inline uint32_t bitCount64(uint64_t mask)
+	{
+#if defined(_MSC_VER)
+		mask = mask - ((mask >> 1) & 0x5555555555555555ULL);
+		mask = (mask & 0x3333333333333333ULL) + ((mask >> 2) & 0x3333333333333333ULL);
+		mask = (mask + (mask >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		return (uint32_t)((mask * 0x0101010101010101ULL) >> 56);
+#else
+		return __builtin_popcountll(mask);
+#endif
+	}
+
+	// ֵĹϣֵڶӽڵֱÿδ8ֽ
+	static inline uint32_t hashName(const char* str, size_t len)
+	{
+		const uint64_t mul = 0x9E3779B97F4A7C15ULL;
+		uint64_t h = len * mul, w;
+
+		for ( ; len >= 8; len -= 8, str += 8)
+		{
+			memcpy(&w, str, 8);
+			h = (h ^ w) * mul;
+			h ^= h >> 29;
+		}
+		if (len)
+		{
+			w = 0;
+			for (size_t i = 0; i < len; ++ i)
+				w |= (uint64_t)(uint8_t)str[i] << (i * 8);
+			h = (h ^ w) * mul;
+		}
+
+		// ֻõλٻһÿһλֽܵڵӰ
+		h ^= h >> 33;
+		h *= 0xFF51AFD7ED558CCDULL;
+		h ^= h >> 33;
+		return (uint32_t)h;
+	}
+
+	// жϰС8ֽǷַ
+	static inline bool isEightDigits(uint64_t chunk)
+	{
+		return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+	}
+
+	// С8ַתΪSWARÿγ˷ͬʱϲڵ֣
+	static inline uint32_t parseEightDigits(uint64_t chunk)
+	{
+		const uint64_t mask = 0x000000FF000000FFULL;
+		const uint64_t mul1 = 0x000F424000000064ULL;	// 100 + (1000000 << 32)
+		const uint64_t mul2 = 0x0000271000000001ULL;	// 1 + (10000 << 32)
+
+		chunk -= 0x3030303030303030ULL;
+		chunk = (chunk * 10) + (chunk >> 8);
+		chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+
+		return (uint32_t)chunk;
+	}
+
+	// ֵַһҪ⴦ַ˫šбܻNULLƫƣûҵ򷵻len
+	static inline size_t findStringSpecial(const char* src, size_t len)
+	{
+		size_t i = 0;
+
+#ifdef SFJ_AVX2_OPT
+		const __m256i quote32 = _mm256_set1_epi8('"'), slash32 = _mm256_set1_epi8('\\'), zero32 = _mm256_setzero_si256();
+		for ( ; i + 32 <= len; i += 32)
+		{
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			__m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote32), _mm256_cmpeq_epi8(v, slash32)), _mm256_cmpeq_epi8(v, zero32));
+			uint32_t mask = (uint32_t)_mm256_movemask_epi8(m);
+			if (mask)
+				return i + bitScan32(mask);
+		}
+#endif
+#ifdef SFJ_SSE2_OPT
+		const __m128i quote16 = _mm_set1_epi8('"'), slash16 = _mm_set1_epi8('\\'), zero16 = _mm_setzero_si128();
+		for ( ; i + 16 <= len; i += 16)
+		{
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			__m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote16), _mm_cmpeq_epi8(v, slash16)), _mm_cmpeq_epi8(v, zero16));
+			uint32_t mask = (uint32_t)_mm_movemask_epi8(m);
+			if (mask)
+				return i + bitScan32(mask);
+		}
+#endif
+
+		for ( ; i < len; ++ i)
+		{
+			uint8_t ch = src[i];
+			if (ch == '"' || ch == '\\' || ch == 0)
+				break;
+		}
+
+		return i;
+	}
+
+	// ҵһǿհףո\t\r\nַƫƣûҵ򷵻len
+	static inline size_t findNonWhite(const char* src, size_t len)
+	{
+		size_t i = 0;
+
+#ifdef SFJ_AVX2_OPT
+		const __m256i space32 = _mm256_set1_epi8(' '), tab32 = _mm256_set1_epi8('\t'), lf32 = _mm256_set1_epi8('\n'), cr32 = _mm256_set1_epi8('\r');
+		for ( ; i + 32 <= len; i += 32)
+		{
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			__m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, space32), _mm256_cmpeq_epi8(v, tab32)),
+				_mm256_or_si256(_mm256_cmpeq_epi8(v, lf32), _mm256_cmpeq_epi8(v, cr32)));
+			uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(m);
+			if (mask)
+				return i + bitScan32(mask);
+		}
+#endif
+#ifdef SFJ_SSE2_OPT
+		const __m128i space16 = _mm_set1_epi8(' '), tab16 = _mm_set1_epi8('\t'), lf16 = _mm_set1_epi8('\n'), cr16 = _mm_set1_epi8('\r');
+		for ( ; i + 16 <= len; i += 16)
+		{
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			__m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space16), _mm_cmpeq_epi8(v, tab16)),
+				_mm_or_si128(_mm_cmpeq_epi8(v, lf16), _mm_cmpeq_epi8(v, cr16)));
+			uint32_t mask = ~(uint32_t)_mm_movemask_epi8(m) & 0xFFFF;
+			if (mask)
+				return i + bitScan32(mask);
+		}
+#endif
+
+		for ( ; i < len; ++ i)
+		{
+			uint8_t ch = src[i];
+			if (ch > 32 || json_invisibles_allowed[ch] != 1)
+				break;
+		}
+
+		return i;
+	}
+
+	// ұʱҪתַ˫šбܺС0x20Ŀַƫƣûҵ򷵻len
+	// ǷҪתescapeStringjson_escape_charsflagsжϣ0x80ϵֽڶᱻת
+	static inline size_t findEscapeCandidate(const char* src, size_t len)
+	{
+		size_t i = 0;
+
+#ifdef SFJ_AVX2_OPT
+		const __m256i quote32 = _mm256_set1_epi8('"'), slash32 = _mm256_set1_epi8('\\'), ctrl32 = _mm256_set1_epi8(0x1F);
+		for ( ; i + 32 <= len; i += 32)
+		{
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			__m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote32), _mm256_cmpeq_epi8(v, slash32)), _mm256_cmpeq_epi8(_mm256_min_epu8(v, ctrl32), v));
+			uint32_t mask = (uint32_t)_mm256_movemask_epi8(m);
+			if (mask)
+				return i + bitScan32(mask);
+		}
+#endif
+#ifdef SFJ_SSE2_OPT
+		const __m128i quote16 = _mm_set1_epi8('"'), slash16 = _mm_set1_epi8('\\'), ctrl16 = _mm_set1_epi8(0x1F);
+		for ( ; i + 16 <= len; i += 16)
+		{
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			__m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote16), _mm_cmpeq_epi8(v, slash16)), _mm_cmpeq_epi8(_mm_min_epu8(v, ctrl16), v));
+			uint32_t mask = (uint32_t)_mm_movemask_epi8(m);
+			if (mask)
+				return i + bitScan32(mask);
+		}
+#endif
+
+		for ( ; i < len; ++ i)
+		{
+			uint8_t ch = src[i];
+			if (ch < 0x20 || ch == '"' || ch == '\\')
+				break;
+		}
+
+		return i;
+	}
+
+	// һзƫƣûҵ򷵻len
+	static inline size_t findLineEnd(const char* src, size_t len)
+	{
+		size_t i = 0;
+
+#ifdef SFJ_AVX2_OPT
+		const __m256i lf32 = _mm256_set1_epi8('\n');
+		for ( ; i + 32 <= len; i += 32)
+		{
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, lf32));
+			if (mask)
+				return i + bitScan32(mask);
+		}
+#endif
+#ifdef SFJ_SSE2_OPT
+		const __m128i lf16 = _mm_set1_epi8('\n');
+		for ( ; i + 16 <= len; i += 16)
+		{
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, lf16));
+			if (mask)
+				return i + bitScan32(mask);
+		}
+#endif
+
+		for ( ; i < len; ++ i)
+		{
+			if (src[i] == '\n')
+				break;
+		}
+
+		return i;
 	}
 
 	enum sfJSONValueType
@@ -244,36 +599,168 @@ namespace sfjson {
 
 	const size_t MemNodeSIZE = 8192 - sizeof(MemNode);
 
+	// jsonתַдbufBufMemListFlatBufferStringBufferSizeCounterֻṩaddString/addChar2/reserve
+	template <typename Buf> static void escapeStringTo(Buf& buf, const char* src, size_t len, uint32_t flags)
+	{
+		uint8_t v;
+		uint32_t unicode;
+		size_t i = 0, spos = 0;
+		const char upperChars[] = { "0123456789ABCDEF" };
+
+		while (i < len)
+		{
+			// Ҫתַתַ߽ʱһθ
+			i += findEscapeCandidate(src + i, len - i);
+			if (i >= len)
+				break;
+
+			uint8_t ch = src[i];
+			if (ch == 0)
+			{
+				// ΪʲôNULLַ????
+				if (i > spos)
+					buf.addString(src + spos, i - spos);
+				spos = ++ i;
+				continue;
+			}
+
+			if (!(flags & kJsonSimpleEscape))
+				v = json_escape_chars[ch];
+			else if (ch == '\\' || ch == '"')
+				v = 1;
+			else
+				v = 0;
+
+			if (v == 0)
+			{
+				// defered
+				++ i;
+				continue;
+			}
+
+			if (v == 1)
+			{
+				// escape some chars
+				if (i > spos)
+					buf.addString(src + spos, i - spos);
+				buf.addChar2('\\', ch);
+				spos = ++ i;
+			}
+			else if (v == 2)
+			{
+				if (flags & kJsonUnicodes)
+				{
+					// defered
+					if ((ch & 0xE0) == 0xC0)		//2 bit count
+						i += 2;
+					else if ((ch & 0xF0) == 0xE0)	//3 bit count
+						i += 3;
+					else if ((ch & 0xF8) == 0xF0)	//4 bit count
+						i += 4;
+					else
+						i ++;
+
+					continue;
+				}
+
+				if (i > spos)
+					buf.addString(src + spos, i - spos);
+
+				// check utf8
+				uint8_t* utf8src = (uint8_t*)src + i;
+				if ((ch & 0xE0) == 0xC0)
+				{
+					//2 bit count
+					unicode = ch & 0x1F;
+					unicode = (unicode << 6) | (utf8src[1] & 0x3F);
+					i += 2;
+				}
+				else if ((ch & 0xF0) == 0xE0)
+				{
+					//3 bit count
+					unicode = ch & 0xF;
+					unicode = (unicode << 6) | (utf8src[1] & 0x3F);
+					unicode = (unicode << 6) | (utf8src[2] & 0x3F);
+					i += 3;
+				}
+				else if ((ch & 0xF8) == 0xF0)
+				{
+					//4 bit count
+					unicode = ch & 0x7;
+					unicode = (unicode << 6) | (utf8src[1] & 0x3F);
+					unicode = (unicode << 6) | (utf8src[2] & 0x3F);
+					unicode = (unicode << 6) | (utf8src[3] & 0x3F);
+					i += 4;
+				}
+				else
+				{
+					unicode = '?';
+					i ++;
+					assert(0);
+				}
+
+				char* utf8dst = buf.reserve(6);
+				utf8dst[0] = '\\';
+				utf8dst[1] = 'u';
+
+				utf8dst[2] = upperChars[(unicode >> 12) & 0xF];
+				utf8dst[3] = upperChars[(unicode >> 8) & 0xF];
+				utf8dst[4] = upperChars[(unicode >> 4) & 0xF];
+				utf8dst[5] = upperChars[unicode & 0xF];
+
+				spos = i;
+			}
+			else
+			{
+				// invisible(s) to visibled
+				if (i > spos)
+					buf.addString(src + spos, i - spos);
+				buf.addChar2('\\', v);
+				spos = ++ i;
+			}
+		}
+
+		if (i > spos)
+			buf.addString(src + spos, i - spos);
+	}
+
 	class MemList
 	{
 	public:
 		MemNode		*first, *last;
+		MemNode		*wrapped;		// ⲿṩڴĽڵ㣬Ҫͷ
 
 	public:
 		inline MemList() 
-			: first(NULL), last(NULL)
+			: first(NULL), last(NULL), wrapped(NULL)
 		{}
 		~MemList()
 		{
 			MemNode* n = first, *nn;
-			if (n)
+			while(n)
 			{
-				n = n->next;
-				while(n)
-				{
-					nn = n->next;
-					free(n);
-					n = nn;
-				}
+				nn = n->next;
+				if (n != wrapped)
+					memFree(n);
+				n = nn;
 			}
 		}
 
 		MemNode* newNode(size_t size = MemNodeSIZE)
 		{
-			MemNode* n = (MemNode*)malloc(size + sizeof(MemNode));
+			// reset֮Ľڵ㣬Ļֱʹ
+			MemNode* n = last ? last->next : NULL;
+			if (n && n->total >= size)
+			{
+				n->used = 0;
+				last = n;
+				return n;
+			}
+
+			n = (MemNode*)memAlloc(size + sizeof(MemNode));
 			new (n) MemNode();
 
-			n->next = NULL;
+			n->next = last ? last->next : NULL;
 			n->total = size;
 			n->used = 0;
 
@@ -284,6 +771,14 @@ namespace sfjson {
 			last = n;
 			return n;
 		}
+		// ݵеĽڵ㣬֮ʱظʹ
+		void reset()
+		{
+			for (MemNode* n = first; n; n = n->next)
+				n->used = 0;
+			last = first;
+		}
+
 		MemNode* wrapNode(char* buf, size_t fixedBufSize)
 		{
 			assert(fixedBufSize >= sizeof(MemNode) + 16);
@@ -292,6 +787,8 @@ namespace sfjson {
 			new (n) MemNode();
 			n->total = fixedBufSize - sizeof(MemNode);
 			n->used = 0;
+			n->next = NULL;
+			wrapped = n;
 
 			if (first)
 				last->next = n;
@@ -348,123 +845,22 @@ namespace sfjson {
 			return ptr;
 		}
 
-		void escapeString(const char* src, size_t len, uint32_t flags)
+		inline void escapeString(const char* src, size_t len, uint32_t flags)
 		{
-			uint8_t v;
-			uint32_t unicode;
-			size_t i = 0, spos = 0;
-			const char upperChars[] = { "0123456789ABCDEF" };
+			escapeStringTo(*this, src, len, flags);
+		}
 
-			while (i < len)
+		// һΰָСڴ棬ַд
+		void* reserveAligned(size_t len)
+		{
+			MemNode* n = (MemNode*)last;
+			if (n)
 			{
-				uint8_t ch = src[i];
-				if (ch == 0)
-				{
-					// ΪʲôNULLַ????
-					if (i > spos)
-						addString(src + spos, i - spos);
-					spos = ++ i;
-					continue;
-				}
-
-				if (!(flags & kJsonSimpleEscape))
-					v = json_escape_chars[ch];
-				else if (ch == '\\' || ch == '"')
-					v = 1;
-				else
-					v = 0;
-
-				if (v == 0)
-				{
-					// defered
-					++ i;
-					continue;
-				}
-
-				if (v == 1)
-				{
-					// escape some chars
-					if (i > spos)
-						addString(src + spos, i - spos);
-					addChar2('\\', ch);
-					spos = ++ i;
-				}
-				else if (v == 2)
-				{
-					if (flags & kJsonUnicodes)
-					{
-						// defered
-						if ((ch & 0xE0) == 0xC0)		//2 bit count
-							i += 2;
-						else if ((ch & 0xF0) == 0xE0)	//3 bit count
-							i += 3;
-						else if ((ch & 0xF8) == 0xF0)	//4 bit count
-							i += 4;
-						else
-							i ++;
-
-						continue;
-					}
-
-					if (i > spos)
-						addString(src + spos, i - spos);
-
-					// check utf8
-					uint8_t* utf8src = (uint8_t*)src + i;
-					if ((ch & 0xE0) == 0xC0)
-					{
-						//2 bit count
-						unicode = ch & 0x1F;
-						unicode = (unicode << 6) | (utf8src[1] & 0x3F);
-						i += 2;
-					}
-					else if ((ch & 0xF0) == 0xE0)
-					{
-						//3 bit count
-						unicode = ch & 0xF;
-						unicode = (unicode << 6) | (utf8src[1] & 0x3F);
-						unicode = (unicode << 6) | (utf8src[2] & 0x3F);
-						i += 3;
-					}
-					else if ((ch & 0xF8) == 0xF0)
-					{
-						//4 bit count
-						unicode = ch & 0x7;
-						unicode = (unicode << 6) | (utf8src[1] & 0x3F);
-						unicode = (unicode << 6) | (utf8src[2] & 0x3F);
-						unicode = (unicode << 6) | (utf8src[3] & 0x3F);
-						i += 4;
-					}
-					else
-					{
-						unicode = '?';
-						i ++;
-						assert(0);
-					}
-
-					char* utf8dst = reserve(6);
-					utf8dst[0] = '\\';
-					utf8dst[1] = 'u';
-
-					utf8dst[2] = upperChars[(unicode >> 12) & 0xF];
-					utf8dst[3] = upperChars[(unicode >> 8) & 0xF];
-					utf8dst[4] = upperChars[(unicode >> 4) & 0xF];
-					utf8dst[5] = upperChars[unicode & 0xF];
-
-					spos = i;
-				}
-				else
-				{
-					// invisible(s) to visibled
-					if (i > spos)
-						addString(src + spos, i - spos);
-					addChar2('\\', v);
-					spos = ++ i;
-				}
+				size_t pad = (0 - (size_t)((char*)(n + 1) + n->used)) & (sizeof(void*) - 1);
+				if (n->used + pad + len < n->total)
+					n->used += pad;
 			}
-
-			if (i > spos)
-				addString(src + spos, i - spos);
+			return reserve(len);
 		}
 
 		char* reserve(size_t len)
@@ -473,7 +869,7 @@ namespace sfjson {
 			MemNode* n = (MemNode*)last;
 
 			// һڵʣµĿռ䲻ҪĻֱӷһȫµlenô
-			if (n->used + len < n->total)
+			if (n && n->used + len < n->total)
 			{
 				ptr = (char*)(n + 1);
 				ptr += n->used;
@@ -489,319 +885,188 @@ namespace sfjson {
 		}
 	};
 
-	template <typename T, size_t BlockSize = 4096> class TMemoryPool
+	// 壬дλɵ֤߱㹻SizeCounter׼ȷĳȣκα߽
+	// MemListͬдӿڣһη䡢ÿֻֽдһεı
+	class FlatBuffer
 	{
 	public:
-		typedef T               value_type;
-		typedef T*              pointer;
-		typedef size_t          size_type;
+		char		*pos;
 
-		TMemoryPool() throw()
+	public:
+		inline FlatBuffer(char* buf) : pos(buf) {}
+
+		inline void addChar(char ch) { *pos ++ = ch; }
+		inline void addChar2(char ch1, char ch2) { pos[0] = ch1; pos[1] = ch2; pos += 2; }
+		inline void addString(const char* s, size_t len) { memcpy(pos, s, len); pos += len; }
+		inline char* reserve(size_t len) { char* ptr = pos; pos += len; return ptr; }
+
+		inline void escapeString(const char* src, size_t len, uint32_t flags)
 		{
-			currentBlock_ = 0;
-			currentSlot_ = 0;
-			lastSlot_ = 0;
-			freeSlots_ = 0;
-			slotsCount_ = 0;
+			escapeStringTo(*this, src, len, flags);
 		}
+	};
 
-		inline ~TMemoryPool() throw()
+	// ֱдstd::string壬ռ䲻ʱַĳȳɱresize0дݣʱfinishصĲ
+	class StringBuffer
+	{
+	public:
+		std::string	&str;
+		char		*pos, *end;
+
+	public:
+		inline StringBuffer(std::string& s, size_t initSize)
+			: str(s)
 		{
-			freeall();
+			size_t used = str.size();
+			str.resize(used + initSize);
+			pos = &str[0] + used;
+			end = &str[0] + str.size();
 		}
 
-		inline pointer allocate(size_t cc = 1)
+		inline void addChar(char ch) { if (pos == end) grow(1); *pos ++ = ch; }
+		inline void addChar2(char ch1, char ch2) { if (end - pos < 2) grow(2); pos[0] = ch1; pos[1] = ch2; pos += 2; }
+		inline void addString(const char* s, size_t len) { if ((size_t)(end - pos) < len) grow(len); memcpy(pos, s, len); pos += len; }
+		inline char* reserve(size_t len) { if ((size_t)(end - pos) < len) grow(len); char* ptr = pos; pos += len; return ptr; }
+
+		inline void escapeString(const char* src, size_t len, uint32_t flags)
 		{
-			assert(cc == 1);
-
-			slotsCount_ ++;
-			if (freeSlots_ != 0) {
-				pointer result = reinterpret_cast<pointer>(freeSlots_);
-				freeSlots_ = freeSlots_->next;
-				return result;
-			}
-
-			if (currentSlot_ >= lastSlot_)
-				allocateBlock();
-			return reinterpret_cast<pointer>(currentSlot_++);
-		}
-		inline void deallocate(pointer p, size_type cc = 0)
-		{
-			if (p != 0) {
-				slotsCount_ --;
-				reinterpret_cast<slot_pointer_>(p)->next = freeSlots_;
-				freeSlots_ = reinterpret_cast<slot_pointer_>(p);
-			}
-		}
-
-	private:
-		union Slot_ {
-			char objspace[sizeof(value_type)];
-			Slot_* next;
-		};
-
-		typedef char* data_pointer_;
-		typedef Slot_ slot_type_;
-		typedef Slot_* slot_pointer_;
-
-		slot_pointer_ currentBlock_;
-		slot_pointer_ currentSlot_;
-		slot_pointer_ lastSlot_;
-		slot_pointer_ freeSlots_;
-		size_type	  slotsCount_;
-
-		size_type padPointer(data_pointer_ p, size_type align) const throw()
-		{
-			size_t result = reinterpret_cast<size_t>(p);
-			return ((align - result) % align);
+			escapeStringTo(*this, src, len, flags);
 		}
 
-		void allocateBlock(data_pointer_ newBlock = 0)
+		inline void finish()
 		{
-			if (!newBlock)
-				newBlock = reinterpret_cast<data_pointer_>(operator new(BlockSize));
-
-			reinterpret_cast<slot_pointer_>(newBlock)->next = currentBlock_;
-			currentBlock_ = reinterpret_cast<slot_pointer_>(newBlock);
-
-			data_pointer_ body = newBlock + sizeof(slot_pointer_);
-			size_type bodyPadding = padPointer(body, sizeof(slot_type_));
-			currentSlot_ = reinterpret_cast<slot_pointer_>(body + bodyPadding);
-			lastSlot_ = reinterpret_cast<slot_pointer_>(newBlock + BlockSize - sizeof(slot_type_) + 1);
+			str.resize(pos - &str[0]);
 		}
 
-		void freeall()
+	private:
+		void grow(size_t len)
 		{
-			slot_pointer_ curr = currentBlock_;
-			while (curr != 0) {
-				slot_pointer_ prev = curr->next;
-				operator delete(reinterpret_cast<void*>(curr));
-				curr = prev;
-			}
-
-			currentBlock_ = 0;
-			currentSlot_ = 0;
-			lastSlot_ = 0;
-			freeSlots_ = 0;
-			slotsCount_ = 0;
+			size_t used = pos - &str[0];
+			str.resize(std::max(str.size() * 2, used + len));
+			pos = &str[0] + used;
+			end = &str[0] + str.size();
 		}
 	};
 
-	//////////////////////////////////////////////////////////////////////////
-
-	// JSON File Object
-	class JFile
+	// ֻͳƳȲݣMemListͬдӿڡreserveصһʱڴ棬дݻᱻ
+	class SizeCounter
 	{
-		friend class ::sfNode;
 	public:
-		enum
-		{
-			kErrorNotClosed = 1,
-			kErrorEnd,
-			kErrorAttribute,
-			kErrorCloseNode,
-			kErrorName,
-			kErrorSymbol,
-			kErrorMaxDeeps,
-			kErrorValue
-		};
-
-	private:
-		typedef TMemoryPool<sfNodeBase> NodesPool;
-
-		char				*m_pMemEnd;
-		char				*m_pLastPos;
-		size_t				m_nMemSize;
-		int					m_iErr;
-		sfJSONValueType		kValType;
-
-		NodesPool			m_nodesPool;
-		MemList				m_strBuf;
-		uint32_t			m_nOpens;
-		uint32_t			m_opens[SFJ_MAX_PARSE_LEVEL];
-		sfNodeBase			*m_nodeOpens[SFJ_MAX_PARSE_LEVEL];
-		sfNodeBase			*m_pRoot;
+		size_t		total;
+		char		scratch[16];
 
 	public:
-		inline JFile(size_t nSize)
-			: m_nMemSize(nSize)
-			, m_pLastPos(NULL)
-			, m_iErr(0)
-			, m_nOpens(0)
-			, m_pRoot(NULL)
-		{
-			initJsonEscapeChars();
-		}
+		inline SizeCounter() : total(0) {}
 
-		inline JFile(char* init, size_t nSize)
-			: m_nMemSize(0)
-			, m_pLastPos(NULL)
-			, m_iErr(0)
-			, m_nOpens(0)
-			, m_pRoot(NULL)
-		{
-			initJsonEscapeChars();
-			m_strBuf.wrapNode(init, nSize);
-		}
-
-		~JFile()
-		{
-		}
-
-		inline sfNode* getRoot()
-		{
-			m_pRoot->pFile = this;
-			return (sfNode*)m_pRoot;
-		}
-
-		sfNode* newRoot(bool bIsObject)
-		{
-			m_pRoot = m_nodesPool.allocate();
-			memset(m_pRoot, 0, sizeof(sfNodeBase));
-
-			m_pRoot->pFile = this;
-			m_pRoot->nodeType = bIsObject ? JATObject : JATArray;
+		inline void addChar(char) { total ++; }
+		inline void addChar2(char, char) { total += 2; }
+		inline void addString(const char*, size_t len) { total += len; }
+		inline char* reserve(size_t len) { assert(len <= sizeof(scratch)); total += len; return scratch; }
 
-			return (sfNode*)m_pRoot;
-		}
-
-		size_t parse(char* pMemory)
+		inline void escapeString(const char* src, size_t len, uint32_t flags)
 		{
-			if (!pMemory)
-				pMemory = (char*)(this + 1);
-			m_pMemEnd = pMemory + m_nMemSize;
-
-			char* pReadPos = parseRoot(m_pLastPos = pMemory);
-			if (!pReadPos)
-				return 0;
-
-			if (m_nOpens)
-			{
-				//δر
-				m_iErr = kErrorNotClosed;
-				return 0;
-			}
-
-			return pReadPos - pMemory;
+			escapeStringTo(*this, src, len, flags);
 		}
+	};
 
-		const char* getError()
-		{
-			switch (m_iErr)
-			{
-			case kErrorNotClosed:
-			{
-				static char msg[] = { "node not closed" };
-				return msg;
-			}
-			break;
-
-			case kErrorEnd:
-			{
-				static char msg[] = { "error end" };
-				return msg;
-			}
-			break;
-
-			case kErrorAttribute:
-			{
-				static char msg[] = { "error attribute or value" };
-				return msg;
-			}
-			break;
-
-			case kErrorCloseNode:
-			{
-				static char msg[] = { "incorrected close node" };
-				return msg;
-			}
-			break;
-
-			case kErrorName:
-			{
-				static char msg[] = { "name with no data" };
-				return msg;
-			}
-			break;
+	//////////////////////////////////////////////////////////////////////////
+	// ڵŴͽոʽõıͲ
+	/*
+	 * ͨúֻͨʲNodesȡڵ㣬ÿָʽṩһ
+	 *   typedef Ref								ڵãָ롢λû±꣩0ʾû
+	 *   uint32_t type(Ref)							JsonAttrType
+	 *   Ref child(Ref)								ĵһӽڵ
+	 *   Ref next(Ref, bool bInObject)				һֵܽڵ㣬bInObjectΪڵǷΪ
+	 *   const char* name(Ref, size_t& len)			ڶе
+	 *   const char* string(Ref, size_t& len)		ֵַ
+	 *   bool boolean(Ref)int64_t integer(Ref)double number(Ref)
+	 */
+
+	// СʽszBuf32ֽڣس
+	static inline size_t formatInteger(int64_t val, char* szBuf)
+	{
+#ifdef _SFJSON_CRTOPT_H__
+		return opt_i64toa(val, szBuf);
+#else
+		return sprintf(szBuf, "%lld", (long long)val);
+#endif
+	}
+	static inline size_t formatDouble(double val, char* szBuf)
+	{
+#ifdef _SFJSON_CRTOPT_H__
+		return opt_dtoa(val, szBuf);
+#else
+		return sprintf(szBuf, "%f", val);
+#endif
+	}
 
-			case kErrorSymbol:
-			{
-				static char msg[] = { "unrecognize/invalid symbol" };
-				return msg;
-			}
-			break;
+	// ڵķʲ
+	class TreeNodes
+	{
+	public:
+		typedef const sfNodeBase* Ref;
+
+		inline uint32_t type(Ref n) const { return n->nodeType; }
+		inline Ref child(Ref n) const { return (Ref)n->child; }
+		inline Ref next(Ref n, bool) const { return (Ref)n->next; }
+		inline const char* name(Ref n, size_t& len) const { assert(n->nameKey); len = n->nameLength; return n->nameKey; }
+		inline const char* string(Ref n, size_t& len) const { len = n->valLength; return n->strval; }
+		inline bool boolean(Ref n) const { return n->bval; }
+		inline int64_t integer(Ref n) const { return n->ival; }
+		inline double number(Ref n) const { return n->dval; }
+	};
 
-			case kErrorMaxDeeps:
-			{
-				static char msg[] = { "exceed max parse deepths" };
-				return msg;
-			}
-			break;
+	// ӽڵ㣨βţBufΪMemListʱֶΪSizeCounterʱֻ㳤ȣΪFlatBuffer/StringBufferʱֱдڴ
+	// ݹ飺һʽջÿһĸڵ㣬ǰǷΪֻڽͷʱжһ
+	template <typename Nodes, typename Buf> static void printMembers(Buf& encodeBuf, const Nodes& nodes, typename Nodes::Ref container, uint32_t flags)
+	{
+		typedef typename Nodes::Ref Ref;
 
-			case kErrorValue:
-			{
-				static char msg[] = { "special value must be one of true|false|null" };
-				return msg;
-			}
-			break;
-			}
+		size_t len, depth = 0, stackSize = SFJ_ENCODE_STACK_SIZE;
+		Ref fixStack[SFJ_ENCODE_STACK_SIZE];
+		Ref* stack = fixStack;
+		char szBuf[32] = { 0 };
+		const char* str;
 
-			return "";
-		}
+		bool inObject = nodes.type(container) == JATObject;
+		Ref n = nodes.child(container);
+		if (!n)
+			return;
 
-		size_t summary(char* outs, size_t maxl)
+		for ( ; ; )
 		{
-			size_t bytes = std::min((size_t)(m_pMemEnd - m_pLastPos), maxl);
-
-			memcpy(outs, m_pLastPos, bytes);
-			return bytes;
-		}
-
-		void printToBuffer(MemList& encodeBuf, sfNodeBase* node, sfNodeBase* parent, uint32_t flags)
-		{			
-			size_t len;
-			sfNodeBase* n;
-			char szBuf[32] = { 0 };
-
-			if (parent->nodeType == JATObject)
+			if (inObject)
 			{
-				assert(node->nameKey);
-
+				str = nodes.name(n, len);
 				encodeBuf.addChar('"');
-				encodeBuf.addString(node->nameKey, node->nameLength);
+				encodeBuf.addString(str, len);
 				encodeBuf.addChar2('"', ':');
 			}
 
-			switch (node->nodeType)
+			uint32_t t = nodes.type(n);
+			switch (t)
 			{
 			case JATBooleanValue:
-				if (node->bval)
+				if (nodes.boolean(n))
 					encodeBuf.addString("true", 4);
 				else
 					encodeBuf.addString("false", 5);
 				break;
 
 			case JATIntValue:
-#ifdef _SFJSON_CRTOPT_H__
-				len = opt_i64toa(node->ival, szBuf);
-#else
-				len = sprintf(szBuf, "%lld", node->ival);
-#endif
+				len = formatInteger(nodes.integer(n), szBuf);
 				encodeBuf.addString(szBuf, len);
 				break;
 
 			case JATDoubleValue:
-#ifdef _SFJSON_CRTOPT_H__
-				len = opt_dtoa(node->dval, szBuf);
-#else
-				len = sprintf(szBuf, "%f", node->dval);
-#endif
+				len = formatDouble(nodes.number(n), szBuf);
 				encodeBuf.addString(szBuf, len);
 				break;
 
 			case JATString:
+				str = nodes.string(n, len);
 				encodeBuf.addChar('"');
-				encodeBuf.escapeString(node->strval, node->valLength, flags);
+				encodeBuf.escapeString(str, len, flags);
 				encodeBuf.addChar('"');
 				break;
 
@@ -809,1180 +1074,5770 @@ namespace sfjson {
 				encodeBuf.addString("null", 4);
 				break;
 
-			case JATObject:			
-				encodeBuf.addChar('{');
-				len = 0;
-				n = (sfNodeBase*)node->child;
-				while (n)
+			case JATObject:
+			case JATArray:
+			{
+				Ref c = nodes.child(n);
+				if (!c)
 				{
-					if (len ++ > 0)
-						encodeBuf.addChar(',');
-					printToBuffer(encodeBuf, n, node, flags);
-					n = (sfNodeBase*)n->next;
+					encodeBuf.addChar2(t == JATObject ? '{' : '[', t == JATObject ? '}' : ']');
+					break;
 				}
-				encodeBuf.addChar('}');
-				break;
 
-			case JATArray:
-				encodeBuf.addChar('[');
-				len = 0;
-				n = (sfNodeBase*)node->child;
-				while (n)
+				// һ
+				if (depth == stackSize)
 				{
-					if (len ++ > 0)
-						encodeBuf.addChar(',');
-					printToBuffer(encodeBuf, n, node, flags);
-					n = (sfNodeBase*)n->next;
+					Ref* newStack = (Ref*)memAlloc(stackSize * 2 * sizeof(Ref));
+					memcpy(newStack, stack, stackSize * sizeof(Ref));
+					if (stack != fixStack)
+						memFree(stack);
+					stack = newStack;
+					stackSize *= 2;
 				}
-				encodeBuf.addChar(']');
-				break;
+				stack[depth ++] = container;
+
+				container = n;
+				inObject = t == JATObject;
+				encodeBuf.addChar(inObject ? '{' : '[');
+				n = c;
+				continue;
+			}
 			}
-		}
 
-	private:
-		sfNodeBase* openNode(uint32_t kAttr, sfNodeBase* parent)
-		{
-			sfNodeBase* n = m_nodesPool.allocate();
-			memset(n, 0, sizeof(sfNodeBase));
+			// ǰѾĻ㷵أȻһֵܽڵ
+			Ref next;
+			while (!(next = nodes.next(n, inObject)))
+			{
+				if (depth == 0)
+				{
+					if (stack != fixStack)
+						memFree(stack);
+					return;
+				}
 
-			n->nodeType = kAttr;
-			m_opens[m_nOpens] = kAttr;
-			m_nodeOpens[m_nOpens ++] = n;
+				encodeBuf.addChar(inObject ? '}' : ']');
+				n = container;
+				container = stack[-- depth];
+				inObject = nodes.type(container) == JATObject;
+			}
 
-			if (parent)
-			{
-				parent->childCount ++;
-				if (parent->child)
-					((sfNodeBase*)parent->childLast)->next = (sfNode*)n;
-				else
-					parent->child = (sfNode*)n;
-				parent->childLast = (sfNode*)n;
-			}
-
-			return n;
+			encodeBuf.addChar(',');
+			n = next;
 		}
+	}
 
-		sfNodeBase* openNode(uint32_t kAttr, sfJSONString& name, sfNodeBase* parent)
-		{
-			sfNodeBase* n = openNode(kAttr, parent);
+	// MemListбõνصһλصʱcodeΪNULLlenΪܳ
+	template <typename Fn> static void printMemList(const MemList& encodeBuf, Fn fn, void* user)
+	{
+		size_t total = 0;
+		MemNode* n;
+
+		for (n = encodeBuf.first; n; n = n->next)
+			total += n->used;
 
-			n->nameKey = name.pString;
-			n->nameLength = name.nLength;
-			n->nameKey[n->nameLength] = 0;
+		fn(NULL, total, user);
+		for (n = encodeBuf.first; n; n = n->next)
+			fn((char*)(n + 1), n->used, user);
+	}
 
-			return n;
-		}
+	// ֵתַ׷ӵstrOutַҲת壬鲻
+	template <typename Nodes> static void valueToString(const Nodes& nodes, typename Nodes::Ref n, std::string& strOut)
+	{
+		size_t len;
+		char szBuf[32];
+		const char* str;
 
-		sfNodeBase* addValueNode(bool bIsString, sfJSONString& val, sfNodeBase* parent)
+		switch (nodes.type(n))
 		{
-			sfNodeBase* n = m_nodesPool.allocate();
-			memset(n, 0, sizeof(sfNodeBase));
+		case JATString:
+			str = nodes.string(n, len);
+			strOut.append(str, len);
+			break;
 
-			if (bIsString)
-			{
-				n->strval = val.pString;
-				n->valLength = val.nLength;
-				n->nodeType = JATString;
-				n->strval[n->valLength] = 0;
-			}
+		case JATBooleanValue:
+			if (nodes.boolean(n))
+				strOut.append("true", 4);
 			else
-			{
-				switch (val.kType)
-				{
-				case JVTTrue:
-					n->bval = true;
-					n->nodeType = JATBooleanValue;
-					break;
-				case JVTFalse:
-					n->bval = false;
-					n->nodeType = JATBooleanValue;
-					break;
-				case JVTDouble:
-					n->dval = val.dbl;
-					n->nodeType = JATDoubleValue;
-					break;
-				case JVTDecimal:
-				case JVTOctal:
-				case JVTHex:
-					n->ival = val.i64;
-					n->nodeType = JATIntValue;
-					break;
-				case JVTNull:
-					n->dval = 0;
-					n->nodeType = JATNullValue;
-					break;
-				}
-			}
+				strOut.append("false", 5);
+			break;
 
-			parent->childCount ++;
-			if (parent->child)
-				((sfNodeBase*)parent->childLast)->next = (sfNode*)n;
-			else
-				parent->child = (sfNode*)n;
-			parent->childLast = (sfNode*)n;
+		case JATIntValue:
+			len = formatInteger(nodes.integer(n), szBuf);
+			strOut.append(szBuf, len);
+			break;
 
-			return n;
+		case JATDoubleValue:
+			len = formatDouble(nodes.number(n), szBuf);
+			strOut.append(szBuf, len);
+			break;
+
+		case JATNullValue:
+			strOut.append("null", 4);
+			break;
 		}
+	}
 
-		char* parseRoot(char* pReadPos)
+	// ڶаңͬӽڵʱصһ
+	template <typename Nodes> static typename Nodes::Ref findMember(const Nodes& nodes, typename Nodes::Ref container, const char* key, size_t len)
+	{
+		typename Nodes::Ref n;
+		for (n = nodes.child(container); n; n = nodes.next(n, true))
 		{
-			SFJ_SKIP_WHITES();
+			size_t nameLength;
+			const char* name = nodes.name(n, nameLength);
+			if (nameLength == len && memcmp(name, key, len) == 0)
+				break;
+		}
+		return n;
+	}
 
-			if (pReadPos[0] == '[')
-			{
-				pReadPos = parseArray(pReadPos + 1, m_pRoot = openNode(JATArray, NULL));
-			}
-			else if (pReadPos[0] == '{')
-			{
-				pReadPos = parseObject(pReadPos + 1, m_pRoot = openNode(JATObject, NULL));
-			}
-			else
-			{
-				m_iErr = kErrorSymbol;
-				return 0;
-			}
+	// indexӽڵ㣬ʱ0
+	template <typename Nodes> static typename Nodes::Ref indexMember(const Nodes& nodes, typename Nodes::Ref container, uint32_t index)
+	{
+		bool inObject = nodes.type(container) == JATObject;
+		typename Nodes::Ref n = nodes.child(container);
+		for (uint32_t i = 0; i < index && n; ++ i)
+			n = nodes.next(n, inObject);
+		return n;
+	}
 
-			return pReadPos;
-		}
+	// ṹ׶νĵһ׶Σ
+	/*
+	 * ÿδ64ֽڣΪÿֽһbitõšбܡṹţ{}[]:,Ϳհ׵λͼ
+	 * Ȼǰ׺PCLMULʱ޽λ˷Щֽλַڣ
+	 * ַĽṹšַʼšֵַĵһַλμ¼
+	 */
+	class StructIndex
+	{
+	public:
+		uint32_t		*positions;
+		size_t			count;
 
-		char* parseObject(char* pReadPos, sfNodeBase* parent)
+	public:
+		inline StructIndex()
+			: positions(NULL), count(0), capacity(0)
+		{}
+		inline ~StructIndex()
 		{
-			if (m_nOpens == SFJ_MAX_PARSE_LEVEL)
-			{
-				m_iErr = kErrorMaxDeeps;
-				return 0;
-			}
+			if (positions)
+				memFree(positions);
+		}
 
-			SFJ_SKIP_WHITES();
+		// ͷλ飬һbuildʱ·
+		void release()
+		{
+			if (positions)
+				memFree(positions);
+			positions = NULL;
+			count = capacity = 0;
+		}
 
-			// 					
-			char endChar = 0;
-			sfJSONString name, val;
-			uint32_t cc = 0, eqSyms = 0;			
+		bool build(const char* src, size_t len)
+		{
+			uint64_t prevEscaped = 0, prevInString = 0, prevScalar = 0;
+			uint8_t tail[64];
 
-			m_pLastPos = pReadPos;
-			while (pReadPos != m_pMemEnd)
+			count = 0;
+			for (size_t pos = 0; pos < len; pos += 64)
 			{
-				SFJ_SKIP_WHITES();
-
-				if (pReadPos[0] == '"')
+				const uint8_t* block = (const uint8_t*)src + pos;
+				if (len - pos < 64)
 				{
-					pReadPos = parseFetchString(pReadPos, name);
-					if (!pReadPos)
-						return 0;
+					// 64ֽڵĲÿո
+					memset(tail, ' ', sizeof(tail));
+					memcpy(tail, block, len - pos);
+					block = tail;
+				}
 
-					//ȡһţð
-					SFJ_SKIP_TO(':');
+				if (capacity - count < 64 && !grow())
+					return false;
 
-					pReadPos ++;
-					SFJ_SKIP_WHITES();
+				uint64_t quote, backslash, op, white;
+				classifyBlock(block, quote, backslash, op, white);
 
-					//ж黹Object
-					if (pReadPos[0] == '[')
-					{
-						//
-						pReadPos = parseArray(pReadPos + 1, openNode(JATArray, name, parent));
-						if (!pReadPos)
-							return 0;
-					}
-					else if (pReadPos[0] == '{')
-					{
-						//ݹӽڵ
-						pReadPos = parseObject(pReadPos + 1, openNode(JATObject, name, parent));
-						if (!pReadPos)
-							return 0;
-					}
-					else
-					{
-						//ȡֵ
-						bool bQuoteStart;
-						pReadPos = parseFetchString(pReadPos, val, &bQuoteStart);
-						if (!pReadPos)
-							return 0;
-						
-						sfNodeBase* n = addValueNode(bQuoteStart, val, parent);
-						n->nameKey = name.pString;
-						n->nameLength = name.nLength;
-						n->nameKey[n->nameLength] = 0;
-					}
+				uint64_t escaped = findEscaped(backslash, prevEscaped);
+				quote &= ~escaped;
 
-					SFJ_SKIP_WHITES();
-					endChar = pReadPos[0];
+				uint64_t inString = prefixXor(quote) ^ prevInString;
+				prevInString = (uint64_t)((int64_t)inString >> 63);
 
-					cc ++;
-				}
-				else if (cc == 0 && pReadPos[0] == '}')
+				// ֵֵַtruefalsenullֻ¼һַ
+				uint64_t scalar = ~(op | white | quote | inString);
+				uint64_t scalarStarts = scalar & ~((scalar << 1) | prevScalar);
+				prevScalar = scalar >> 63;
+
+				uint64_t structurals = (op & ~inString) | (quote & inString) | scalarStarts;
+				while (structurals)
 				{
-					//յĴ
-					endChar = '}';
+					positions[count ++] = (uint32_t)(pos + bitScan64(structurals));
+					structurals &= structurals - 1;
 				}
-				else
+			}
+
+			return true;
+		}
+
+		// src[0]ſʼƥ䣬֮ƥ֮ƫƣûбպʱ0ŵͺڲ﷨
+		static size_t matchBracket(const char* src, size_t len)
+		{
+			uint64_t prevEscaped = 0, prevInString = 0;
+			uint64_t deeps = 0;
+			uint8_t tail[64];
+
+			for (size_t pos = 0; pos < len; pos += 64)
+			{
+				const uint8_t* block = (const uint8_t*)src + pos;
+				if (len - pos < 64)
 				{
-					m_iErr = kErrorSymbol;
-					return 0;
+					memset(tail, ' ', sizeof(tail));
+					memcpy(tail, block, len - pos);
+					block = tail;
 				}
 
-				//ȡһţֻǶŻ}
-				if (endChar == '}')
-				{
-					if (m_nOpens == 0 || m_opens[m_nOpens - 1] != JATObject)
-						return 0;
+				uint64_t quote, backslash, open, close;
+				classifyBrackets(block, quote, backslash, open, close);
 
-					m_nOpens --;
-					return pReadPos + 1;
-				}
-				else if (endChar == ',')
+				quote &= ~findEscaped(backslash, prevEscaped);
+
+				uint64_t inString = prefixXor(quote) ^ prevInString;
+				prevInString = (uint64_t)((int64_t)inString >> 63);
+
+				open &= ~inString;
+				close &= ~inString;
+
+				// ڵǰʱһڲܱպϣ
+				uint32_t closes = bitCount64(close);
+				if (deeps > closes)
 				{
-					pReadPos ++;
+					deeps = deeps + bitCount64(open) - closes;
+					continue;
 				}
-				else
+
+				uint64_t brackets = open | close;
+				while (brackets)
 				{
-					return 0;
+					uint64_t lowest = brackets & (0 - brackets);
+					if (lowest & open)
+						deeps ++;
+					else if (-- deeps == 0)
+						return pos + bitScan64(lowest) + 1;
+					brackets ^= lowest;
 				}
 			}
 
-			m_iErr = kErrorNotClosed;
-			return pReadPos;
+			return 0;
 		}
 
-		//ȡ
-		char* parseArray(char* pReadPos, sfNodeBase* parent)
+		// н룺src[0]ǶţΪÿtargets[i]ҵλĵһ㶺ţԪصķֽ磩ƫдsplits[i]ûʱд0
+		// ضŵƫƣûбպʱ0targetsǵ
+		static size_t findSplits(const char* src, size_t len, const size_t* targets, size_t* splits, uint32_t count)
 		{
-			uint32_t cc = 0;
+			uint64_t prevEscaped = 0, prevInString = 0;
+			uint64_t deeps = 0;
+			uint32_t t = 0;
+			uint8_t tail[64];
 
-			if (m_nOpens == SFJ_MAX_PARSE_LEVEL)
+			for (size_t pos = 0; pos < len; pos += 64)
 			{
-				m_iErr = kErrorMaxDeeps;
-				return 0;
-			}
+				const uint8_t* block = (const uint8_t*)src + pos;
+				if (len - pos < 64)
+				{
+					memset(tail, ' ', sizeof(tail));
+					memcpy(tail, block, len - pos);
+					block = tail;
+				}
 
-			sfJSONString val;
-			m_pLastPos = pReadPos;
+				uint64_t quote, backslash, open, close;
+				classifyBrackets(block, quote, backslash, open, close);
 
-			while (pReadPos != m_pMemEnd)
-			{
-				SFJ_SKIP_WHITES();
+				quote &= ~findEscaped(backslash, prevEscaped);
 
-				uint8_t ch = pReadPos[0];
-				if (ch == '{')
-				{
-					//һµĽڵĿʼ
-					pReadPos = parseObject(pReadPos + 1, openNode(JATObject, parent));
-				}
-				else if (ch == '[')
-				{
-					//һµĽڵĿʼ
-					pReadPos = parseArray(pReadPos + 1, openNode(JATArray, parent));
-				}
-				else if (ch == ',')
+				uint64_t inString = prefixXor(quote) ^ prevInString;
+				prevInString = (uint64_t)((int64_t)inString >> 63);
+
+				open &= ~inString;
+				close &= ~inString;
+
+				// һڲҪҶţҲܱպʱ
+				uint32_t closes = bitCount64(close);
+				if ((t == count || targets[t] >= pos + 64) && deeps > closes)
 				{
-					//ֵ
-					pReadPos ++;
+					deeps = deeps + bitCount64(open) - closes;
 					continue;
 				}
-				else if (ch == ']')
-				{
-					//
-					if (m_nOpens == 0 || m_opens[m_nOpens - 1] != JATArray)
-						return 0;
-
-					m_nOpens --;
-					pReadPos ++;
 
-					break;
-				}
-				else if (ch == '"' || json_value_char_tbl[ch] <= 2 || json_value_char_tbl[ch] >= 4)
+				uint64_t comma = t < count ? classifyComma(block) & ~inString : 0;
+				uint64_t bits = open | close | comma;
+				while (bits)
 				{
-					//ֵ
-					bool bQuoteStart;
-					pReadPos = parseFetchString(pReadPos, val, &bQuoteStart);
-					if (!pReadPos)
-						break;
+					uint64_t lowest = bits & (0 - bits);
+					size_t offset = pos + bitScan64(lowest);
 
-					addValueNode(bQuoteStart, val, parent);
-				}
-				else
-				{
-					m_iErr = kErrorSymbol;
-					pReadPos = 0;
+					if (lowest & open)
+					{
+						deeps ++;
+					}
+					else if (lowest & close)
+					{
+						if (-- deeps == 0)
+						{
+							for ( ; t < count; ++ t)
+								splits[t] = 0;
+							return offset;
+						}
+					}
+					else if (deeps == 1 && t < count && offset >= targets[t])
+					{
+						splits[t ++] = offset;
+					}
+					bits ^= lowest;
 				}
+			}
 
-				if (!pReadPos)
-					break;
+			return 0;
+		}
 
-				cc ++;
-			}
+	private:
+		size_t			capacity;
 
-			return pReadPos;
+		bool grow()
+		{
+			size_t newCapacity = capacity ? capacity * 2 : 1024;
+			uint32_t* p = (uint32_t*)memRealloc(positions, newCapacity * sizeof(uint32_t));
+			if (!p)
+				return false;
+
+			positions = p;
+			capacity = newCapacity;
+			return true;
 		}
 
-		//ӸλÿʼȡһֱַոΪֹ֧˫ַͷ˫ַ
-		char* parseFetchString(char* pReadPos, sfJSONString& str, bool* pbQuoteStart = NULL)
+		static inline void classifyBlock(const uint8_t* block, uint64_t& quote, uint64_t& backslash, uint64_t& op, uint64_t& white)
 		{
-			char* pStart = str.pString = pReadPos, *pEndPos = 0;
-			bool bQuoteStart = pStart[0] == '"';
+#ifdef SFJ_SSE2_OPT
+			const __m128i quote16 = _mm_set1_epi8('"'), slash16 = _mm_set1_epi8('\\');
+			const __m128i case16 = _mm_set1_epi8(0x20), lbrace16 = _mm_set1_epi8('{'), rbrace16 = _mm_set1_epi8('}');
+			const __m128i colon16 = _mm_set1_epi8(':'), comma16 = _mm_set1_epi8(',');
+			const __m128i space16 = _mm_set1_epi8(' '), tab16 = _mm_set1_epi8('\t'), lf16 = _mm_set1_epi8('\n'), cr16 = _mm_set1_epi8('\r');
+
+			quote = backslash = op = white = 0;
+			for (uint32_t i = 0; i < 4; ++ i)
+			{
+				__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+				// []0x20λֱ֮{}ͬ
+				__m128i lower = _mm_or_si128(v, case16);
+
+				uint64_t q = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote16));
+				uint64_t b = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, slash16));
+				uint64_t o = (uint32_t)_mm_movemask_epi8(_mm_or_si128(
+					_mm_or_si128(_mm_cmpeq_epi8(lower, lbrace16), _mm_cmpeq_epi8(lower, rbrace16)),
+					_mm_or_si128(_mm_cmpeq_epi8(v, colon16), _mm_cmpeq_epi8(v, comma16))));
+				uint64_t w = (uint32_t)_mm_movemask_epi8(_mm_or_si128(
+					_mm_or_si128(_mm_cmpeq_epi8(v, space16), _mm_cmpeq_epi8(v, tab16)),
+					_mm_or_si128(_mm_cmpeq_epi8(v, lf16), _mm_cmpeq_epi8(v, cr16))));
+
+				quote |= q << (i * 16);
+				backslash |= b << (i * 16);
+				op |= o << (i * 16);
+				white |= w << (i * 16);
+			}
+#else
+			quote = backslash = op = white = 0;
+			for (uint32_t i = 0; i < 64; ++ i)
+			{
+				uint64_t bit = 1ULL << i;
+				switch (block[i])
+				{
+				case '"': quote |= bit; break;
+				case '\\': backslash |= bit; break;
+				case '{': case '}': case '[': case ']': case ':': case ',': op |= bit; break;
+				case ' ': case '\t': case '\n': case '\r': white |= bit; break;
+				}
+			}
+#endif
+		}
 
-			if (pbQuoteStart)
-				*pbQuoteStart = bQuoteStart;
-			m_pLastPos = pReadPos;
+		static inline void classifyBrackets(const uint8_t* block, uint64_t& quote, uint64_t& backslash, uint64_t& open, uint64_t& close)
+		{
+#ifdef SFJ_SSE2_OPT
+			const __m128i quote16 = _mm_set1_epi8('"'), slash16 = _mm_set1_epi8('\\');
+			const __m128i case16 = _mm_set1_epi8(0x20), lbrace16 = _mm_set1_epi8('{'), rbrace16 = _mm_set1_epi8('}');
 
-			if (bQuoteStart)
+			quote = backslash = open = close = 0;
+			for (uint32_t i = 0; i < 4; ++ i)
 			{
-				// ֵַ
-				pReadPos ++;
-				str.pString = pEndPos = pReadPos;
+				__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+				__m128i lower = _mm_or_si128(v, case16);
 
-				size_t i;
-				uint8_t ch;
-				for (i = 0; i < m_pMemEnd - pReadPos; ++ i)
+				quote |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote16)) << (i * 16);
+				backslash |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, slash16)) << (i * 16);
+				open |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(lower, lbrace16)) << (i * 16);
+				close |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(lower, rbrace16)) << (i * 16);
+			}
+#else
+			quote = backslash = open = close = 0;
+			for (uint32_t i = 0; i < 64; ++ i)
+			{
+				uint64_t bit = 1ULL << i;
+				switch (block[i])
 				{
-					ch = pReadPos[i];
-					if (ch == 0)
-					{
-						m_iErr = kErrorEnd;
-						return 0;
-					}
-
-					if (ch == '"' || ch == '\\')
-						break;
+				case '"': quote |= bit; break;
+				case '\\': backslash |= bit; break;
+				case '{': case '[': open |= bit; break;
+				case '}': case ']': close |= bit; break;
 				}
+			}
+#endif
+		}
 
-				pReadPos += i;
-				pEndPos = pReadPos;
+		static inline uint64_t classifyComma(const uint8_t* block)
+		{
+			uint64_t comma = 0;
+#ifdef SFJ_SSE2_OPT
+			const __m128i comma16 = _mm_set1_epi8(',');
+			for (uint32_t i = 0; i < 4; ++ i)
+			{
+				__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+				comma |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, comma16)) << (i * 16);
+			}
+#else
+			for (uint32_t i = 0; i < 64; ++ i)
+			{
+				if (block[i] == ',')
+					comma |= 1ULL << i;
+			}
+#endif
+			return comma;
+		}
 
-				if (ch == '\\')
-				{
-					// ʱchΪ\˵ַкתţ˽תַĴ̡ĴֱӽֵַĻȡ
-					while (pReadPos < m_pMemEnd)
-					{
-						if (ch == '\\')
-						{
-							uint8_t next = json_unescape_chars[pReadPos[1]];
-							if (next == 0)
-							{
-								m_iErr = kErrorSymbol;
-								return 0;
-							}
+		// ҳбתַбܲŻתַ
+		static inline uint64_t findEscaped(uint64_t backslash, uint64_t& prevEscaped)
+		{
+			if (!backslash)
+			{
+				uint64_t escaped = prevEscaped;
+				prevEscaped = 0;
+				return escaped;
+			}
 
-							if (next == 'u')
-							{
-								// UnicodeUTF8
-								uint32_t unicode = readUnicode(pReadPos + 2);
-								pEndPos = unicode2utf8(unicode, pEndPos);
-								pReadPos += 6;
-							}
-							else
-							{
-								*pEndPos ++ = next;
-								pReadPos += 2;
-							}
-						}
-						else if (ch != '"')
-						{
-							*pEndPos ++ = ch;
-							pReadPos ++;
-						}
-						else
-							break;
+			const uint64_t evenBits = 0x5555555555555555ULL;
 
-						ch = pReadPos[0];
-					}
-				}
+			backslash &= ~prevEscaped;
+			uint64_t followsEscape = (backslash << 1) | prevEscaped;
+			uint64_t oddSequenceStarts = backslash & ~evenBits & ~followsEscape;
+			uint64_t sequencesStartingOnEvenBits = oddSequenceStarts + backslash;
 
-				if (pReadPos >= m_pMemEnd)
-				{
-					m_iErr = kErrorEnd;
-					return 0;
-				}
-			}
-			else
-			{
-				// ֵֵȴӵ1Ų²һ¿ʲô͵ֵ
-				sfJSONValueType kValType = JVTNone;
-				bool bNegativeVal = false;
+			prevEscaped = sequencesStartingOnEvenBits < oddSequenceStarts ? 1 : 0;
+			uint64_t invertMask = sequencesStartingOnEvenBits << 1;
 
-				uint8_t ch = pReadPos[0];
-				if (ch == '+')
-				{
-					pReadPos ++;
-					ch = pReadPos[0];
-				}
-				else if (ch == '-')
-				{
-					pReadPos ++;
-					ch = pReadPos[0];
-					bNegativeVal = true;
-				}
+			return (evenBits ^ invertMask) & followsEscape;
+		}
 
-				uint8_t ctl = json_value_char_tbl[ch];
-				if (ch == '0')
-				{
-					// 8ƻ16ƿ
-					pReadPos ++;
-					ch = pReadPos[0];
-					if (ch == 'x' || ch == 'X')
-					{
-						// ʮ
-						pReadPos ++;
-						kValType = JVTHex;
-						if (bNegativeVal)
-						{
-							m_iErr = kErrorValue;
-							return 0;
-						}
-					}
-					else if (ch == '.')
-					{
-						// С
-						kValType = JVTDouble;
-					}
-					else
-					{
-						// ˽
-						kValType = JVTOctal;
-					}
-				}
-				else if (ctl == 1)
-				{
-					// ʮֿͷС
-					char* pTest = pReadPos + 1;
+		// ÿһλΪиλ򣬼֮λȫ1
+		static inline uint64_t prefixXor(uint64_t bits)
+		{
+#ifdef SFJ_CLMUL_OPT
+			__m128i r = _mm_clmulepi64_si128(_mm_set_epi64x(0, (int64_t)bits), _mm_set1_epi8((char)0xFF), 0);
+			return (uint64_t)_mm_cvtsi128_si64(r);
+#else
+			bits ^= bits << 1;
+			bits ^= bits << 2;
+			bits ^= bits << 4;
+			bits ^= bits << 8;
+			bits ^= bits << 16;
+			bits ^= bits << 32;
+			return bits;
+#endif
+		}
+	};
 
-					kValType = JVTDecimal;
-					while (pTest < m_pMemEnd)
-					{
-						ch = *pTest ++;
-						if (ch < 32 || ch >= 128)
-							return 0;
-						if (json_allends_allowed[ch])
-							break;
-						if (json_value_char_tbl[ch] != 1)
-						{
-							kValType = JVTDouble;
-							break;
-						}
-					}
-				}
-				else if (ctl >= 4 && ctl <= 7)
-				{
-					// ֵ
-					if (strncmp(pReadPos, "true", 4) == 0)
-					{
-						kValType = JVTTrue;
-						pReadPos += 4;
-					}
-					else if (strncmp(pReadPos, "false", 5) == 0)
-					{
-						kValType = JVTFalse;
-						pReadPos += 5;
-					}
-					else if (strncmp(pReadPos, "null", 4) == 0)
-					{
-						kValType = JVTNull;
-						pReadPos += 4;
-					}
-					else
-					{
-						m_iErr = kErrorValue;
-						return 0;
-					}
+	//////////////////////////////////////////////////////////////////////////
 
-					if (!json_allends_allowed[pReadPos[0]])
-					{
-						m_iErr = kErrorValue;
-						return 0;
-					}
-				}
-				else if (ch == '.')
-				{
-					// 
-					kValType = JVTDouble;
-				}
+	template <typename T, size_t BlockSize = 4096> class TMemoryPool
+	{
+	public:
+		typedef T               value_type;
+		typedef T*              pointer;
+		typedef size_t          size_type;
 
-				// תֵ
-				str.kType = kValType;
-				switch (kValType)
-				{
-				case JVTDecimal:
-					str.i64 = strtoull(pReadPos, &pReadPos, 10);
-					break;
-				case JVTHex:
-					str.i64 = strtoull(pReadPos, &pReadPos, 16);
-					break;
-				case JVTOctal:
-					str.i64 = strtoull(pReadPos, &pReadPos, 8);
-					break;
-				case JVTDouble:
-					str.dbl = strtod(pReadPos, &pReadPos);
-					break;
-				}
+		TMemoryPool() throw()
+		{
+			blockSize_ = BlockSize;
+			freeBlocks_ = 0;
+			currentBlock_ = 0;
+			currentSlot_ = 0;
+			lastSlot_ = 0;
+			freeSlots_ = 0;
+			slotsCount_ = 0;
+		}
 
-				if (pReadPos >= m_pMemEnd)
-				{
-					m_iErr = kErrorEnd;
-					return 0;
-				}
+		inline ~TMemoryPool() throw()
+		{
+			freeall();
+		}
+
+		inline pointer allocate(size_t cc = 1)
+		{
+			assert(cc == 1);
+
+			slotsCount_ ++;
+			if (freeSlots_ != 0) {
+				pointer result = reinterpret_cast<pointer>(freeSlots_);
+				freeSlots_ = freeSlots_->next;
+				return result;
 			}
 
-			str.nLength = (pEndPos ? pEndPos : pReadPos) - pStart;
-			if (bQuoteStart)
+			if (currentSlot_ >= lastSlot_)
+				allocateBlock();
+			return reinterpret_cast<pointer>(currentSlot_++);
+		}
+		// ȴⲿṩڴз䣬ٷµڴ顣ⲿڴ治ڴأᱻͷ
+		void attach(void* mem, size_t size)
+		{
+			data_pointer_ body = reinterpret_cast<data_pointer_>(mem);
+			size_type bodyPadding = padPointer(body, sizeof(slot_type_));
+			if (size < bodyPadding + sizeof(slot_type_))
+				return;
+
+			currentSlot_ = reinterpret_cast<slot_pointer_>(body + bodyPadding);
+			lastSlot_ = reinterpret_cast<slot_pointer_>(body + size - sizeof(slot_type_) + 1);
+		}
+		// ԤƻҪsizeֽڣһηµڴʱٷôࣨSFJ_NODES_BLOCK_MAX
+		void expect(size_t size)
+		{
+			size = std::min(size, (size_t)SFJ_NODES_BLOCK_MAX);
+			while (blockSize_ < size)
+				blockSize_ *= 2;
+		}
+
+		// ٷʱǷҪµڴ
+		inline bool full() const
+		{
+			return freeSlots_ == 0 && currentSlot_ >= lastSlot_;
+		}
+
+		// ͷзȥĶ󣬵ڴ飬֮allocateظʹЩڴ
+		void reset()
+		{
+			if (currentBlock_)
 			{
-				str.nLength --;
-				pReadPos ++;
+				block_pointer_ tail = currentBlock_;
+				while (tail->next)
+					tail = tail->next;
+				tail->next = freeBlocks_;
+				freeBlocks_ = currentBlock_;
 			}
 
-			return pReadPos;
-		}
+			currentBlock_ = 0;
+			currentSlot_ = 0;
+			lastSlot_ = 0;
+			freeSlots_ = 0;
+			slotsCount_ = 0;
+		}
+
+		inline void deallocate(pointer p, size_type cc = 0)
+		{
+			if (p != 0) {
+				slotsCount_ --;
+				reinterpret_cast<slot_pointer_>(p)->next = freeSlots_;
+				freeSlots_ = reinterpret_cast<slot_pointer_>(p);
+			}
+		}
+
+	private:
+		union Slot_ {
+			char objspace[sizeof(value_type)];
+			Slot_* next;
+		};
+
+		// ÿڴ鿪ͷ¼һڴͱĴС
+		struct Block_ {
+			Block_* next;
+			size_t size;
+		};
+
+		typedef char* data_pointer_;
+		typedef Slot_ slot_type_;
+		typedef Slot_* slot_pointer_;
+		typedef Block_* block_pointer_;
+
+		size_type	  blockSize_;
+		block_pointer_ freeBlocks_;
+		block_pointer_ currentBlock_;
+		slot_pointer_ currentSlot_;
+		slot_pointer_ lastSlot_;
+		slot_pointer_ freeSlots_;
+		size_type	  slotsCount_;
+
+		size_type padPointer(data_pointer_ p, size_type align) const throw()
+		{
+			size_t result = reinterpret_cast<size_t>(p);
+			return ((align - result) % align);
+		}
+
+		void allocateBlock()
+		{
+			block_pointer_ block = freeBlocks_;
+			if (block)
+			{
+				freeBlocks_ = block->next;
+			}
+			else
+			{
+				block = reinterpret_cast<block_pointer_>(memAlloc(blockSize_));
+				block->size = blockSize_;
+#if defined(SFJ_USE_HUGEPAGES) && defined(MADV_HUGEPAGE)
+				adviseHugePages(reinterpret_cast<data_pointer_>(block), blockSize_);
+#endif
+				// һڴӱĵֻҪٵļη
+				if (blockSize_ < SFJ_NODES_BLOCK_MAX)
+					blockSize_ = std::min(blockSize_ * 2, (size_type)SFJ_NODES_BLOCK_MAX);
+			}
+
+			block->next = currentBlock_;
+			currentBlock_ = block;
+
+			data_pointer_ body = reinterpret_cast<data_pointer_>(block + 1);
+			size_type bodyPadding = padPointer(body, sizeof(slot_type_));
+			currentSlot_ = reinterpret_cast<slot_pointer_>(body + bodyPadding);
+			lastSlot_ = reinterpret_cast<slot_pointer_>(reinterpret_cast<data_pointer_>(block) + block->size - sizeof(slot_type_) + 1);
+		}
+
+#if defined(SFJ_USE_HUGEPAGES) && defined(MADV_HUGEPAGE)
+		// ڴа2MBĲʹ͸ҳ
+		static void adviseHugePages(data_pointer_ p, size_type size)
+		{
+			const size_t huge = 2 * 1024 * 1024;
+			size_t start = (reinterpret_cast<size_t>(p) + huge - 1) & ~(huge - 1);
+			size_t end = (reinterpret_cast<size_t>(p) + size) & ~(huge - 1);
+			if (end > start)
+				madvise(reinterpret_cast<void*>(start), end - start, MADV_HUGEPAGE);
+		}
+#endif
+
+		void freeall()
+		{
+			reset();
+
+			block_pointer_ curr = freeBlocks_;
+			while (curr != 0) {
+				block_pointer_ prev = curr->next;
+				memFree(reinterpret_cast<void*>(curr));
+				curr = prev;
+			}
+			freeBlocks_ = 0;
+
+			currentBlock_ = 0;
+			currentSlot_ = 0;
+			lastSlot_ = 0;
+			freeSlots_ = 0;
+			slotsCount_ = 0;
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+#ifdef SFJ_CXX11
+	// ֱĵͬһ֣ͬһֻһָ룬ʱֱӱȽָ
+	/*
+	 * ѰַĹϣCASҲ˿Ա߳ͬʱ롣ּͲɾֱֱ
+	 * ֱڴʱȷ3/4Ժټ֣ЩȻڸԵĵ
+	 */
+	class KeyTable
+	{
+	public:
+		struct Key
+		{
+			uint32_t	hash;
+			uint32_t	length;
+			char		str[1];		// 0β
+		};
+
+	public:
+		explicit KeyTable(uint32_t capacity = 4096)
+			: m_nCount(0)
+		{
+			uint32_t slots = 64;
+			while (slots < capacity)
+				slots <<= 1;
+
+			m_nMask = slots - 1;
+			m_pSlots = (std::atomic<Key*>*)memAlloc(slots * sizeof(std::atomic<Key*>));
+			for (uint32_t i = 0; i < slots; ++ i)
+				new (m_pSlots + i) std::atomic<Key*>(NULL);
+		}
+		~KeyTable()
+		{
+			for (uint32_t i = 0; i <= m_nMask; ++ i)
+			{
+				Key* k = m_pSlots[i].load(std::memory_order_relaxed);
+				if (k)
+					memFree(k);
+			}
+			memFree(m_pSlots);
+		}
+
+		// ȡΨһָ룬ʱ롣ֱʱNULL
+		const char* intern(const char* str, size_t len)
+		{
+			uint32_t h = hashName(str, len);
+			Key* mine = NULL;
+
+			for (uint32_t i = h & m_nMask, probes = 0; probes <= m_nMask; ++ probes, i = (i + 1) & m_nMask)
+			{
+				Key* k = m_pSlots[i].load(std::memory_order_acquire);
+				if (!k)
+				{
+					if (!mine)
+					{
+						if (m_nCount.load(std::memory_order_relaxed) >= (m_nMask + 1) / 4 * 3 || len > 0xFFFFFFF0)
+							return NULL;
+
+						mine = (Key*)memAlloc(sizeof(Key) + len);
+						mine->hash = h;
+						mine->length = (uint32_t)len;
+						memcpy(mine->str, str, len);
+						mine->str[len] = 0;
+					}
+
+					if (m_pSlots[i].compare_exchange_strong(k, mine, std::memory_order_acq_rel))
+					{
+						m_nCount.fetch_add(1, std::memory_order_relaxed);
+						return mine->str;
+					}
+					// ߳ˣkȷŽȥǸ
+				}
+
+				if (k->hash == h && k->length == len && memcmp(k->str, str, len) == 0)
+				{
+					if (mine)
+						memFree(mine);
+					return k->str;
+				}
+			}
+
+			if (mine)
+				memFree(mine);
+			return NULL;
+		}
+		inline const char* intern(const char* str)
+		{
+			return intern(str, strlen(str));
+		}
+
+		// ֻҲ룬ʱNULL
+		const char* lookup(const char* str, size_t len) const
+		{
+			uint32_t h = hashName(str, len);
+			for (uint32_t i = h & m_nMask, probes = 0; probes <= m_nMask; ++ probes, i = (i + 1) & m_nMask)
+			{
+				Key* k = m_pSlots[i].load(std::memory_order_acquire);
+				if (!k)
+					break;
+				if (k->hash == h && k->length == len && memcmp(k->str, str, len) == 0)
+					return k->str;
+			}
+			return NULL;
+		}
+
+		// internصָȡԤõĹϣֵͳ
+		static inline const Key* keyOf(const char* str)
+		{
+			return (const Key*)(str - offsetof(Key, str));
+		}
+
+		inline size_t count() const { return m_nCount.load(std::memory_order_relaxed); }
+
+	private:
+		KeyTable(const KeyTable&);
+		KeyTable& operator = (const KeyTable&);
+
+		std::atomic<Key*>		*m_pSlots;
+		uint32_t				m_nMask;
+		std::atomic<uint32_t>	m_nCount;
+	};
+#endif
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// JSON File Object
+	class JFile
+	{
+		friend class ::sfNode;
+		friend class ::sfJsonCursor;
+		friend class ::sfJsonLazyDoc;
+		friend class ::sfJsonLines;
+		friend class ::sfJsonParser;
+	public:
+		enum
+		{
+			kErrorNotClosed = 1,
+			kErrorEnd,
+			kErrorAttribute,
+			kErrorCloseNode,
+			kErrorName,
+			kErrorSymbol,
+			kErrorMaxDeeps,
+			kErrorValue,
+			kErrorCanceled,
+			kErrorNoMemory
+		};
+
+	private:
+		typedef TMemoryPool<sfNodeBase> NodesPool;
+
+		// ǵݹ루룩ʱ״̬
+		enum
+		{
+			kStateValue,
+			kStateValueOrEnd,
+			kStateName,
+			kStateNameOrEnd,
+			kStateColon,
+			kStateCommaOrEnd,
+			kStateRoot,
+			kStateDone,
+		};
+
+		// ʱݶνضϵֵ
+		enum
+		{
+			kPartialNone,
+			kPartialString,
+			kPartialScalar,
+		};
+
+		char				*m_pMemEnd;
+		char				*m_pLastPos;
+		size_t				m_nMemSize;
+		int					m_iErr;
+		sfJSONValueType		kValType;
+
+		NodesPool			m_nodesPool;
+		MemList				m_strBuf;
+		uint32_t			m_nOpens;
+		uint8_t				m_opens[SFJ_MAX_PARSE_LEVEL];		// ֻJATObject/JATArray1ֽJFileСһЩ
+		sfNodeBase			*m_nodeOpens[SFJ_MAX_PARSE_LEVEL];
+		sfNodeBase			*m_pRoot;
+		JFile				*m_pNextFile;		// нʱ̵߳JFileڵǵڴУ汾ĵһͷ
+		char				*m_pMapped;			// mapFileӳļݣ汾ĵһӳ
+		bool				m_bExternal;		// JFileڴɵṩsfJsonDecodeFixed/sfJsonDecodeArenadestroyʱͷ
+		bool				m_bArenaOnly;		// ڵֻܴӵṩarenaз䣬ʧ
+		bool				m_bNoMemory;		// arenaѾ֮꣬Ľڵ㶼дm_nodeDummy
+		sfNodeBase			m_nodeDummy;
+#ifdef SFJ_CXX11
+		KeyTable			*m_pKeys;
+#endif
+		StructIndex			m_structIndex;		// ׶νĽṹ
+		bool				m_bReusable;		// sfJsonParserʹãm_structIndexڴ棬һν벻ٷ
+
+		// ״̬
+		uint32_t			m_nPushState;
+		uint32_t			m_nPartialKind;
+		bool				m_bPartialEscaped;
+		char				*m_pPartial;
+		size_t				m_nPartial, m_nPartialSize;
+		sfJSONString		m_pushName;
+
+	public:
+		inline JFile(size_t nSize)
+			: m_nMemSize(nSize)
+			, m_pLastPos(NULL)
+			, m_iErr(0)
+			, m_nOpens(0)
+			, m_pRoot(NULL)
+			, m_pNextFile(NULL)
+			, m_pMapped(NULL)
+			, m_bExternal(false)
+			, m_bArenaOnly(false)
+			, m_bNoMemory(false)
+#ifdef SFJ_CXX11
+			, m_pKeys(NULL)
+#endif
+			, m_bReusable(false)
+			, m_nPushState(kStateRoot)
+			, m_nPartialKind(kPartialNone)
+			, m_bPartialEscaped(false)
+			, m_pPartial(NULL)
+			, m_nPartial(0)
+			, m_nPartialSize(0)
+		{
+			initJsonEscapeChars();
+		}
+
+		inline JFile(char* init, size_t nSize)
+			: m_nMemSize(0)
+			, m_pLastPos(NULL)
+			, m_iErr(0)
+			, m_nOpens(0)
+			, m_pRoot(NULL)
+			, m_pNextFile(NULL)
+			, m_pMapped(NULL)
+			, m_bExternal(false)
+			, m_bArenaOnly(false)
+			, m_bNoMemory(false)
+#ifdef SFJ_CXX11
+			, m_pKeys(NULL)
+#endif
+			, m_bReusable(false)
+			, m_nPushState(kStateRoot)
+			, m_nPartialKind(kPartialNone)
+			, m_bPartialEscaped(false)
+			, m_pPartial(NULL)
+			, m_nPartial(0)
+			, m_nPartialSize(0)
+		{
+			initJsonEscapeChars();
+			m_strBuf.wrapNode(init, nSize);
+		}
+
+		~JFile()
+		{
+			if (m_pPartial)
+				memFree(m_pPartial);
+			releaseExtra();
+		}
+
+		// Աٴν롣ڵغַڴ鶼ظʹã֮ǰõнڵ㶼ʹ
+		void reset()
+		{
+			releaseExtra();
+			m_nodesPool.reset();
+			m_strBuf.reset();
+
+			m_pLastPos = NULL;
+			m_iErr = 0;
+			m_nOpens = 0;
+			m_pRoot = NULL;
+			m_bNoMemory = false;
+
+			m_nPushState = kStateRoot;
+			m_nPartialKind = kPartialNone;
+			m_bPartialEscaped = false;
+			m_nPartial = 0;
+		}
+
+		inline sfNode* getRoot()
+		{
+			m_pRoot->pFile = this;
+			return (sfNode*)m_pRoot;
+		}
+
+		sfNode* newRoot(bool bIsObject)
+		{
+			m_pRoot = m_nodesPool.allocate();
+			memset(m_pRoot, 0, sizeof(sfNodeBase));
+
+			m_pRoot->pFile = this;
+			m_pRoot->nodeType = bIsObject ? JATObject : JATArray;
+
+			return (sfNode*)m_pRoot;
+		}
+
+#ifdef SFJ_CXX11
+		// ʹֱеΨһָ룬ֱȱĵ
+		inline void setKeys(KeyTable* pKeys) { m_pKeys = pKeys; }
+#endif
+
+		// JFileڵṩڴУdestroyʱֻͷ
+		inline void setExternal() { m_bExternal = true; }
+
+		// arenaн룺ƵԴͽڵ㶼arenaз䣬õջJFileСarenaʱbHeapFallbackΪtrueӶϼ䣬
+		// ʧܲkErrorNoMemoryֻƽ̣ɺĵ޸ģaddȣȻܴӶϷ
+		size_t parseArena(char* pArena, size_t nArenaSize, const char* code, bool bCopyCode, bool bHeapFallback)
+		{
+			char* pMemory = const_cast<char*>(code);
+			if (bCopyCode)
+			{
+				if (m_nMemSize <= nArenaSize)
+				{
+					pMemory = (char*)memcpy(pArena, code, m_nMemSize);
+					pArena += m_nMemSize;
+					nArenaSize -= m_nMemSize;
+				}
+				else if (bHeapFallback)
+				{
+					pMemory = (char*)memcpy(m_strBuf.reserve(m_nMemSize), code, m_nMemSize);
+				}
+				else
+				{
+					m_iErr = kErrorNoMemory;
+					return 0;
+				}
+			}
+
+			m_nodesPool.attach(pArena, nArenaSize);
+			m_bArenaOnly = !bHeapFallback;
+
+			return parse(pMemory);
+		}
+
+		// ļдʱƵķʽӳ䵽ڴУʱֱӳڴ޸ģдļɹʱļݲڴС
+		char* mapFile(const char* path)
+		{
+			assert(!m_pMapped);
+#ifdef _WINDOWS
+			HANDLE hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+			if (hFile == INVALID_HANDLE_VALUE)
+				return NULL;
+
+			LARGE_INTEGER size;
+			if (GetFileSizeEx(hFile, &size) && size.QuadPart > 0 && (uint64_t)size.QuadPart <= (size_t)-1)
+			{
+				HANDLE hMap = CreateFileMappingA(hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+				if (hMap)
+				{
+					m_pMapped = (char*)MapViewOfFile(hMap, FILE_MAP_COPY, 0, 0, 0);
+					CloseHandle(hMap);
+				}
+				m_nMemSize = (size_t)size.QuadPart;
+			}
+			CloseHandle(hFile);
+#else
+			int fd = open(path, O_RDONLY);
+			if (fd < 0)
+				return NULL;
+
+			struct stat st;
+			if (fstat(fd, &st) == 0 && st.st_size > 0)
+			{
+				void* p = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+				if (p != MAP_FAILED)
+				{
+					// Ǵͷβ˳ȡģںԤҳ
+					madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+					m_pMapped = (char*)p;
+				}
+				m_nMemSize = (size_t)st.st_size;
+			}
+			close(fd);
+#endif
+			if (!m_pMapped)
+				m_nMemSize = 0;
+
+			return m_pMapped;
+		}
+
+		size_t parse(char* pMemory, uint32_t flags = 0)
+		{
+			if (!pMemory)
+				pMemory = (char*)(this + 1);
+			m_pMemEnd = pMemory + m_nMemSize;
+
+			// ƽÿ32ֽԴһڵԤڵصһڴĴС
+			m_nodesPool.expect(m_nMemSize / 32 * sizeof(sfNodeBase));
+
+			char* pReadPos;
+			if ((flags & kJsonDecodeStructural) && m_nMemSize < 0xFFFFFFFF)
+			{
+				pReadPos = parseIndexed(m_pLastPos = pMemory);
+				if (!m_bReusable)
+					m_structIndex.release();
+			}
+			else
+			{
+				DomBuilder builder(this);
+				pReadPos = parseRoot(m_pLastPos = pMemory, builder);
+			}
+			if (m_bNoMemory)
+			{
+				m_iErr = kErrorNoMemory;
+				return 0;
+			}
+			if (!pReadPos)
+				return 0;
+
+			if (m_nOpens)
+			{
+				//δر
+				m_iErr = kErrorNotClosed;
+				return 0;
+			}
+
+			return pReadPos - pMemory;
+		}
+
+		// н룺ڵʱɨһҳԪصķֽ磬ֳnThreadsΣÿһ߳øԵJFile룬ӽڵ
+		// parseȫͬڵ㲻顢ĵ̫С߲֧C++11ʱֱӵparse
+		size_t parseParallel(char* pMemory, uint32_t nThreads)
+		{
+			if (!pMemory)
+				pMemory = (char*)(this + 1);
+			m_pMemEnd = pMemory + m_nMemSize;
+
+#ifdef SFJ_CXX11
+			if (nThreads == 0)
+				nThreads = std::thread::hardware_concurrency();
+			// ֳ256
+			nThreads = (uint32_t)std::min(std::min((size_t)nThreads, m_nMemSize / SFJ_PARALLEL_MIN_CHUNK), (size_t)256);
+
+			char* pReadPos = skipWhites(m_pLastPos = pMemory);
+			if (nThreads < 2 || !pReadPos || pReadPos >= m_pMemEnd || pReadPos[0] != '[')
+				return parse(pMemory);
+
+			// ÿεĽλãһⶼǶ
+			size_t targets[256], splits[256];
+			size_t len = m_pMemEnd - pReadPos;
+			uint32_t i, cc = 0;
+
+			for (i = 1; i < nThreads; ++ i)
+				targets[i - 1] = len / nThreads * i;
+
+			size_t arrayEnd = StructIndex::findSplits(pReadPos, len, targets, splits, nThreads - 1);
+			if (!arrayEnd)
+				return parse(pMemory);
+
+			char* ends[256];
+			for (i = 0; i < nThreads - 1; ++ i)
+			{
+				if (splits[i])
+					ends[cc ++] = pReadPos + splits[i];
+			}
+			ends[cc ++] = pReadPos + arrayEnd;
+
+			// εJFileιm_pNextFile
+			JFile* files[256];
+			JFile** ppNext = &m_pNextFile;
+			for (i = 0; i < cc; ++ i)
+			{
+				files[i] = (JFile*)memAlloc(sizeof(JFile));
+				new (files[i]) JFile(0);
+				files[i]->m_pKeys = m_pKeys;
+
+				*ppNext = files[i];
+				ppNext = &files[i]->m_pNextFile;
+			}
+
+			// ֽĶʱĳţÿζһ
+			for (i = 0; i < cc - 1; ++ i)
+				ends[i][0] = ']';
+
+			// ߳ʧʱ쳣׳ȥѾ߳ûjoinᵼterminateĵĶҲûлָû̵߳Ķڵǰ߳н
+			std::thread threads[256];
+			uint32_t started;
+			for (started = 1; started < cc; ++ started)
+			{
+#ifdef SFJ_EXCEPTIONS
+				try
+				{
+					threads[started] = std::thread(&JFile::parseChunk, files[started], ends[started - 1] + 1, ends[started]);
+				}
+				catch (...)
+				{
+					break;
+				}
+#else
+				threads[started] = std::thread(&JFile::parseChunk, files[started], ends[started - 1] + 1, ends[started]);
+#endif
+			}
+
+			files[0]->parseChunk(pReadPos + 1, ends[0]);
+			for (i = started; i < cc; ++ i)
+				files[i]->parseChunk(ends[i - 1] + 1, ends[i]);
+			for (i = 1; i < started; ++ i)
+				threads[i].join();
+
+			for (i = 0; i < cc - 1; ++ i)
+				ends[i][0] = ',';
+
+			for (i = 0; i < cc; ++ i)
+			{
+				if (files[i]->m_iErr || !files[i]->m_pRoot)
+				{
+					m_iErr = files[i]->m_iErr ? files[i]->m_iErr : kErrorSymbol;
+					m_pLastPos = files[i]->m_pLastPos;
+					return 0;
+				}
+			}
+
+			// Ѹεӽڵӵڵ
+			m_pRoot = newNode(JATArray, NULL);
+			for (i = 0; i < cc; ++ i)
+			{
+				sfNodeBase* r = files[i]->m_pRoot;
+				if (!r->child)
+					continue;
+
+				if (m_pRoot->child)
+					((sfNodeBase*)m_pRoot->childLast)->next = r->child;
+				else
+					m_pRoot->child = r->child;
+				m_pRoot->childLast = r->childLast;
+				m_pRoot->childCount += r->childCount;
+			}
+
+			return ends[cc - 1] + 1 - pMemory;
+#else
+			(void)nThreads;
+			return parse(pMemory);
+#endif
+		}
+
+		// SAXʽ룬κνڵ㣬ֱӻصhandlerӿڼsfJsonParse˵
+		template <typename H> size_t parseSax(char* pMemory, H& handler)
+		{
+			m_pMemEnd = pMemory + m_nMemSize;
+
+			char* pReadPos = parseRoot(m_pLastPos = pMemory, handler);
+			if (!pReadPos)
+				return 0;
+
+			if (m_nOpens)
+			{
+				//δر
+				m_iErr = kErrorNotClosed;
+				return 0;
+			}
+
+			return pReadPos - pMemory;
+		}
+
+		// 룺ݿԷֳδ룬ÿ꼴ͷţֵַᱻƱ档falseʾ
+		bool feed(const char* chunk, size_t len)
+		{
+			if (m_iErr)
+				return false;
+
+			char* pReadPos = const_cast<char*>(chunk);
+			m_pMemEnd = pReadPos + len;
+			m_pLastPos = pReadPos;
+
+			if (m_nPartialKind != kPartialNone)
+			{
+				// Ȱһĩβضϵֵ
+				pReadPos = feedPartial(pReadPos);
+				if (!pReadPos)
+					return m_iErr == 0;
+			}
+
+			while (pReadPos < m_pMemEnd)
+			{
+				pReadPos = skipWhites(pReadPos);
+				if (!pReadPos)
+					return false;
+				if (pReadPos >= m_pMemEnd)
+					break;
+
+				pReadPos = feedToken(pReadPos);
+				if (!pReadPos)
+					return m_iErr == 0;
+			}
+
+			// ݶڷغͿܱͷ
+			m_pMemEnd = m_pLastPos = NULL;
+			return true;
+		}
+
+		// ظڵ㣬ʱNULL
+		sfNode* finish()
+		{
+			if (!m_iErr && (m_nPartialKind != kPartialNone || m_nPushState != kStateDone))
+				m_iErr = m_nPushState == kStateRoot ? kErrorEnd : kErrorNotClosed;
+			if (m_iErr)
+				return NULL;
+
+			return getRoot();
+		}
+
+		const char* getError()
+		{
+			switch (m_iErr)
+			{
+			case kErrorNotClosed:
+			{
+				static char msg[] = { "node not closed" };
+				return msg;
+			}
+			break;
+
+			case kErrorEnd:
+			{
+				static char msg[] = { "error end" };
+				return msg;
+			}
+			break;
+
+			case kErrorAttribute:
+			{
+				static char msg[] = { "error attribute or value" };
+				return msg;
+			}
+			break;
+
+			case kErrorCloseNode:
+			{
+				static char msg[] = { "incorrected close node" };
+				return msg;
+			}
+			break;
+
+			case kErrorName:
+			{
+				static char msg[] = { "name with no data" };
+				return msg;
+			}
+			break;
+
+			case kErrorSymbol:
+			{
+				static char msg[] = { "unrecognize/invalid symbol" };
+				return msg;
+			}
+			break;
+
+			case kErrorMaxDeeps:
+			{
+				static char msg[] = { "exceed max parse deepths" };
+				return msg;
+			}
+			break;
+
+			case kErrorValue:
+			{
+				static char msg[] = { "special value must be one of true|false|null" };
+				return msg;
+			}
+			break;
+
+			case kErrorCanceled:
+			{
+				static char msg[] = { "canceled by handler" };
+				return msg;
+			}
+			break;
+
+			case kErrorNoMemory:
+			{
+				static char msg[] = { "arena exhausted" };
+				return msg;
+			}
+			break;
+			}
+
+			return "";
+		}
+
+		size_t summary(char* outs, size_t maxl)
+		{
+			size_t bytes = std::min((size_t)(m_pMemEnd - m_pLastPos), maxl);
+
+			memcpy(outs, m_pLastPos, bytes);
+			return bytes;
+		}
+
+		// հֵַĲɼַʱô󲢷NULLȫǿհʱm_pMemEnd
+		inline char* skipWhites(char* pReadPos)
+		{
+			// ½ṹֻ֮0~1ոֱж
+			if (pReadPos < m_pMemEnd && (uint8_t)pReadPos[0] > 32)
+				return pReadPos;
+			if (pReadPos + 1 < m_pMemEnd && pReadPos[0] == ' ' && (uint8_t)pReadPos[1] > 32)
+				return pReadPos + 1;
+
+			pReadPos += findNonWhite(pReadPos, m_pMemEnd - pReadPos);
+			if (pReadPos < m_pMemEnd && (uint8_t)pReadPos[0] <= 32)
+			{
+				m_iErr = kErrorSymbol;
+				return 0;
+			}
+
+			return pReadPos;
+		}
+
+	private:
+		// ͷŲнĸJFileӳļ
+		void releaseExtra()
+		{
+			if (m_pNextFile)
+			{
+				m_pNextFile->~JFile();
+				memFree(m_pNextFile);
+				m_pNextFile = NULL;
+			}
+			if (m_pMapped)
+			{
+#ifdef _WINDOWS
+				UnmapViewOfFile(m_pMapped);
+#else
+				munmap(m_pMapped, m_nMemSize);
+#endif
+				m_pMapped = NULL;
+				m_nMemSize = 0;
+			}
+		}
+
+		// нʱһУpStartpEnd֮һĵparseһԸڵ֮ݡʧʱNULL
+		sfNodeBase* parseLine(char* pStart, char* pEnd)
+		{
+			m_pMemEnd = pEnd;
+			m_iErr = 0;
+			m_nOpens = 0;
+			m_pRoot = NULL;
+
+			DomBuilder builder(this);
+			if (!parseRoot(m_pLastPos = pStart, builder))
+			{
+				if (!m_iErr)
+					m_iErr = kErrorEnd;
+				return NULL;
+			}
+			if (m_nOpens)
+			{
+				m_iErr = kErrorNotClosed;
+				return NULL;
+			}
+
+			return m_pRoot;
+		}
+
+		// нһΣpStartʼ뵽pEndΪֹ
+		void parseChunk(char* pStart, char* pEnd)
+		{
+			m_pMemEnd = pEnd + 1;
+			m_nodesPool.expect((pEnd - pStart) / 32 * sizeof(sfNodeBase));
+
+			DomBuilder builder(this);
+			char* pReadPos = parseArray(m_pLastPos = pStart, builder);
+			if (!m_iErr && (pReadPos != m_pMemEnd || m_nOpens))
+				m_iErr = kErrorSymbol;
+		}
+
+		// ýĽڵ֣ʹֱʱֱָΨһһ
+		inline void setName(sfNodeBase* n, char* name, size_t len)
+		{
+			name[len] = 0;
+			n->nameKey = name;
+			n->nameLength = (uint32_t)len;
+#ifdef SFJ_CXX11
+			if (m_pKeys)
+			{
+				const char* key = m_pKeys->intern(name, len);
+				if (key)
+					n->nameKey = const_cast<char*>(key);
+			}
+#endif
+		}
+
+		// һڵ㲢ӵparentӽڵĩβ
+		inline sfNodeBase* newNode(uint32_t kAttr, sfNodeBase* parent)
+		{
+			sfNodeBase* n;
+			if (m_bArenaOnly && m_nodesPool.full())
+			{
+				// arenaѾ꣬еϣparsekErrorNoMemory
+				m_bNoMemory = true;
+				n = &m_nodeDummy;
+				parent = NULL;
+			}
+			else
+			{
+				n = m_nodesPool.allocate();
+			}
+			memset(n, 0, sizeof(sfNodeBase));
+
+			n->nodeType = kAttr;
+			n->pFile = this;
+			if (parent)
+			{
+				parent->childCount ++;
+				if (parent->child)
+					((sfNodeBase*)parent->childLast)->next = (sfNode*)n;
+				else
+					parent->child = (sfNode*)n;
+				parent->childLast = (sfNode*)n;
+			}
+
+			return n;
+		}
+
+		sfNodeBase* openNode(uint32_t kAttr, sfNodeBase* parent)
+		{
+			sfNodeBase* n = newNode(kAttr, parent);
+
+			m_opens[m_nOpens] = kAttr;
+			m_nodeOpens[m_nOpens ++] = n;
+
+			return n;
+		}
+
+		sfNodeBase* openNode(uint32_t kAttr, sfJSONString& name, sfNodeBase* parent)
+		{
+			sfNodeBase* n = openNode(kAttr, parent);
+			setName(n, name.pString, name.nLength);
+
+			return n;
+		}
+
+		sfNodeBase* addValueNode(bool bIsString, sfJSONString& val, sfNodeBase* parent)
+		{
+			sfNodeBase* n = newNode(JATNone, parent);
+
+			if (bIsString)
+			{
+				n->strval = val.pString;
+				n->valLength = val.nLength;
+				n->nodeType = JATString;
+				n->strval[n->valLength] = 0;
+			}
+			else
+			{
+				switch (val.kType)
+				{
+				case JVTTrue:
+					n->bval = true;
+					n->nodeType = JATBooleanValue;
+					break;
+				case JVTFalse:
+					n->bval = false;
+					n->nodeType = JATBooleanValue;
+					break;
+				case JVTDouble:
+					n->dval = val.dbl;
+					n->nodeType = JATDoubleValue;
+					break;
+				case JVTDecimal:
+				case JVTOctal:
+				case JVTHex:
+					n->ival = val.i64;
+					n->nodeType = JATIntValue;
+					break;
+				case JVTNull:
+					n->dval = 0;
+					n->nodeType = JATNullValue;
+					break;
+				default:
+					// JVTNoneɵ֮ǰͱΪkErrorValueᵽ
+					assert(0);
+					break;
+				}
+			}
+
+			return n;
+		}
+
+		// ݹʱڴڵhandlerӿںsfJsonParseҪhandlerȫһ
+		class DomBuilder
+		{
+		public:
+			inline DomBuilder(JFile* pFile)
+				: m_pFile(pFile), m_pName(NULL), m_nNameLength(0)
+			{}
+
+			inline bool onStartObject() { return startNode(JATObject); }
+			inline bool onEndObject(size_t) { return true; }
+			inline bool onStartArray() { return startNode(JATArray); }
+			inline bool onEndArray(size_t) { return true; }
+
+			inline bool onKey(const char* str, size_t len)
+			{
+				m_pName = const_cast<char*>(str);
+				m_nNameLength = (uint32_t)len;
+				return true;
+			}
+			inline bool onString(const char* str, size_t len)
+			{
+				sfNodeBase* n = newValue(JATString);
+				n->strval = const_cast<char*>(str);
+				n->valLength = (uint32_t)len;
+				return !m_pFile->m_bNoMemory;
+			}
+			inline bool onInt64(int64_t val) { newValue(JATIntValue)->ival = val; return !m_pFile->m_bNoMemory; }
+			inline bool onDouble(double val) { newValue(JATDoubleValue)->dval = val; return !m_pFile->m_bNoMemory; }
+			inline bool onBool(bool val) { newValue(JATBooleanValue)->bval = val; return !m_pFile->m_bNoMemory; }
+			inline bool onNull() { newValue(JATNullValue); return !m_pFile->m_bNoMemory; }
+
+		private:
+			JFile			*m_pFile;
+			char			*m_pName;
+			uint32_t		m_nNameLength;
+
+			inline sfNodeBase* newValue(uint32_t kAttr)
+			{
+				JFile* f = m_pFile;
+				sfNodeBase* n = f->newNode(kAttr, f->m_nOpens ? f->m_nodeOpens[f->m_nOpens - 1] : NULL);
+
+				// еֵû֣onKeyֻ֮ʹһ
+				if (m_pName)
+				{
+					f->setName(n, m_pName, m_nNameLength);
+					m_pName = NULL;
+					m_nNameLength = 0;
+				}
+
+				return n;
+			}
+			inline bool startNode(uint32_t kAttr)
+			{
+				JFile* f = m_pFile;
+				sfNodeBase* n = newValue(kAttr);
+
+				// ڻص֮ŰѲѹջ
+				f->m_nodeOpens[f->m_nOpens] = n;
+				if (!f->m_nOpens)
+					f->m_pRoot = n;
+				return !f->m_bNoMemory;
+			}
+		};
+
+		// parseFetchStringȡõֵhandler
+		template <typename H> inline bool deliverValue(H& handler, bool bIsString, sfJSONString& val)
+		{
+			bool r;
+			if (bIsString)
+			{
+				val.pString[val.nLength] = 0;
+				r = handler.onString(val.pString, val.nLength);
+			}
+			else
+			{
+				switch (val.kType)
+				{
+				case JVTTrue: r = handler.onBool(true); break;
+				case JVTFalse: r = handler.onBool(false); break;
+				case JVTDouble: r = handler.onDouble(val.dbl); break;
+				case JVTDecimal:
+				case JVTOctal:
+				case JVTHex: r = handler.onInt64(val.i64); break;
+				case JVTNull: r = handler.onNull(); break;
+				default:
+					m_iErr = kErrorValue;
+					return false;
+				}
+			}
+
+			if (!r)
+				m_iErr = kErrorCanceled;
+			return r;
+		}
+
+		template <typename H> char* parseRoot(char* pReadPos, H& handler)
+		{
+			SFJ_SKIP_WHITES();
+
+			if (pReadPos[0] == '[')
+			{
+				pReadPos = parseArray(pReadPos + 1, handler);
+			}
+			else if (pReadPos[0] == '{')
+			{
+				pReadPos = parseObject(pReadPos + 1, handler);
+			}
+			else
+			{
+				m_iErr = kErrorSymbol;
+				return 0;
+			}
+
+			return pReadPos;
+		}
+
+		template <typename H> char* parseObject(char* pReadPos, H& handler)
+		{
+			if (m_nOpens == SFJ_MAX_PARSE_LEVEL)
+			{
+				m_iErr = kErrorMaxDeeps;
+				return 0;
+			}
+
+			if (!handler.onStartObject())
+			{
+				m_iErr = kErrorCanceled;
+				return 0;
+			}
+			m_opens[m_nOpens ++] = JATObject;
+
+			SFJ_SKIP_WHITES();
+
+			// 					
+			char endChar = 0;
+			sfJSONString name, val;
+			uint32_t cc = 0;
+
+			m_pLastPos = pReadPos;
+			while (pReadPos != m_pMemEnd)
+			{
+				SFJ_SKIP_WHITES();
+
+				if (pReadPos[0] == '"')
+				{
+					pReadPos = parseFetchString(pReadPos, name);
+					if (!pReadPos)
+						return 0;
+
+					name.pString[name.nLength] = 0;
+					if (!handler.onKey(name.pString, name.nLength))
+					{
+						m_iErr = kErrorCanceled;
+						return 0;
+					}
+
+					//ȡһţð
+					SFJ_SKIP_TO(':');
+
+					pReadPos ++;
+					SFJ_SKIP_WHITES();
+
+					//ж黹Object
+					if (pReadPos[0] == '[')
+					{
+						//
+						pReadPos = parseArray(pReadPos + 1, handler);
+						if (!pReadPos)
+							return 0;
+					}
+					else if (pReadPos[0] == '{')
+					{
+						//ݹӽڵ
+						pReadPos = parseObject(pReadPos + 1, handler);
+						if (!pReadPos)
+							return 0;
+					}
+					else
+					{
+						//ȡֵ
+						bool bQuoteStart;
+						pReadPos = parseFetchString(pReadPos, val, &bQuoteStart);
+						if (!pReadPos || !deliverValue(handler, bQuoteStart, val))
+							return 0;
+					}
+
+					SFJ_SKIP_WHITES();
+					endChar = pReadPos[0];
+
+					cc ++;
+				}
+				else if (cc == 0 && pReadPos[0] == '}')
+				{
+					//յĴ
+					endChar = '}';
+				}
+				else
+				{
+					m_iErr = kErrorSymbol;
+					return 0;
+				}
+
+				//ȡһţֻǶŻ}
+				if (endChar == '}')
+				{
+					if (m_nOpens == 0 || m_opens[m_nOpens - 1] != JATObject)
+						return 0;
+
+					m_nOpens --;
+					if (!handler.onEndObject(cc))
+					{
+						m_iErr = kErrorCanceled;
+						return 0;
+					}
+					return pReadPos + 1;
+				}
+				else if (endChar == ',')
+				{
+					pReadPos ++;
+				}
+				else
+				{
+					return 0;
+				}
+			}
+
+			m_iErr = kErrorNotClosed;
+			return pReadPos;
+		}
+
+		//ȡ
+		template <typename H> char* parseArray(char* pReadPos, H& handler)
+		{
+			uint32_t cc = 0;
+
+			if (m_nOpens == SFJ_MAX_PARSE_LEVEL)
+			{
+				m_iErr = kErrorMaxDeeps;
+				return 0;
+			}
+
+			if (!handler.onStartArray())
+			{
+				m_iErr = kErrorCanceled;
+				return 0;
+			}
+			m_opens[m_nOpens ++] = JATArray;
+
+			sfJSONString val;
+			m_pLastPos = pReadPos;
+
+			while (pReadPos != m_pMemEnd)
+			{
+				SFJ_SKIP_WHITES();
+
+				uint8_t ch = pReadPos[0];
+				if (ch == '{')
+				{
+					//һµĽڵĿʼ
+					pReadPos = parseObject(pReadPos + 1, handler);
+				}
+				else if (ch == '[')
+				{
+					//һµĽڵĿʼ
+					pReadPos = parseArray(pReadPos + 1, handler);
+				}
+				else if (ch == ',')
+				{
+					//ֵ
+					pReadPos ++;
+					continue;
+				}
+				else if (ch == ']')
+				{
+					//
+					if (m_nOpens == 0 || m_opens[m_nOpens - 1] != JATArray)
+						return 0;
+
+					m_nOpens --;
+					pReadPos ++;
+
+					if (!handler.onEndArray(cc))
+					{
+						m_iErr = kErrorCanceled;
+						return 0;
+					}
+					break;
+				}
+				else if (ch == '"' || json_value_char_tbl[ch] <= 2 || json_value_char_tbl[ch] >= 4)
+				{
+					//ֵ
+					bool bQuoteStart;
+					pReadPos = parseFetchString(pReadPos, val, &bQuoteStart);
+					if (!pReadPos || !deliverValue(handler, bQuoteStart, val))
+						return 0;
+				}
+				else
+				{
+					m_iErr = kErrorSymbol;
+					pReadPos = 0;
+				}
+
+				if (!pReadPos)
+					break;
+
+				cc ++;
+			}
+
+			return pReadPos;
+		}
+
+		// pReadPospEnd֮Ƿȫǿհ
+		static inline bool onlyWhites(const char* pReadPos, const char* pEnd)
+		{
+			return pReadPos <= pEnd && findNonWhite(pReadPos, pEnd - pReadPos) == (size_t)(pEnd - pReadPos);
+		}
+
+		//׶ν룺Ƚṹٰ˳򹹽ڵٵݹ
+		char* parseIndexed(char* pMemory)
+		{
+			StructIndex& index = m_structIndex;
+			if (!index.build(pMemory, m_nMemSize) || index.count == 0)
+			{
+				m_iErr = kErrorEnd;
+				return 0;
+			}
+
+			uint32_t state;
+			char* pReadPos = pMemory + index.positions[0];
+			if (pReadPos[0] == '[')
+			{
+				m_pRoot = openNode(JATArray, NULL);
+				state = kStateValueOrEnd;
+			}
+			else if (pReadPos[0] == '{')
+			{
+				m_pRoot = openNode(JATObject, NULL);
+				state = kStateNameOrEnd;
+			}
+			else
+			{
+				m_iErr = kErrorSymbol;
+				return 0;
+			}
+
+			sfJSONString name, val;
+			for (size_t k = 1; k < index.count; ++ k)
+			{
+				pReadPos = m_pLastPos = pMemory + index.positions[k];
+				// ֵֻĺ浽һṹֻ֮пհ
+				char* pNext = k + 1 < index.count ? pMemory + index.positions[k + 1] : m_pMemEnd;
+
+				uint8_t ch = pReadPos[0];
+				sfNodeBase* parent = m_nodeOpens[m_nOpens - 1];
+
+				switch (state)
+				{
+				case kStateNameOrEnd:
+					if (ch == '}')
+						goto _closeNode;
+					// fall through
+				case kStateName:
+					if (ch != '"')
+					{
+						m_iErr = kErrorName;
+						return 0;
+					}
+					pReadPos = parseFetchString(pReadPos, name);
+					if (!pReadPos)
+						return 0;
+					if (!onlyWhites(pReadPos, pNext))
+					{
+						m_iErr = kErrorSymbol;
+						return 0;
+					}
+					state = kStateColon;
+					break;
+
+				case kStateColon:
+					if (ch != ':')
+					{
+						m_iErr = kErrorSymbol;
+						return 0;
+					}
+					state = kStateValue;
+					break;
+
+				case kStateValueOrEnd:
+					if (ch == ']')
+						goto _closeNode;
+					// fall through
+				case kStateValue:
+					if (ch == '{' || ch == '[')
+					{
+						if (m_nOpens == SFJ_MAX_PARSE_LEVEL)
+						{
+							m_iErr = kErrorMaxDeeps;
+							return 0;
+						}
+
+						uint32_t kAttr = ch == '{' ? JATObject : JATArray;
+						if (parent->nodeType == JATObject)
+							openNode(kAttr, name, parent);
+						else
+							openNode(kAttr, parent);
+
+						state = ch == '{' ? kStateNameOrEnd : kStateValueOrEnd;
+					}
+					else if (ch > 32 && ch < 128 && ch != ',' && ch != ':' && ch != ']' && ch != '}')
+					{
+						bool bQuoteStart;
+						pReadPos = parseFetchString(pReadPos, val, &bQuoteStart);
+						if (!pReadPos)
+							return 0;
+
+						// ͵ݹdeliverValueһʶֵ絥-Ǵֵŷǿհ׵ַҲǴ
+						if ((!bQuoteStart && val.kType == JVTNone) || !onlyWhites(pReadPos, pNext))
+						{
+							m_iErr = kErrorValue;
+							return 0;
+						}
+
+						sfNodeBase* n = addValueNode(bQuoteStart, val, parent);
+						if (parent->nodeType == JATObject)
+							setName(n, name.pString, name.nLength);
+
+						state = kStateCommaOrEnd;
+					}
+					else
+					{
+						m_iErr = kErrorSymbol;
+						return 0;
+					}
+					break;
+
+				case kStateCommaOrEnd:
+					if (ch == ',')
+					{
+						state = parent->nodeType == JATObject ? kStateName : kStateValue;
+						break;
+					}
+					if ((ch == '}' && parent->nodeType == JATObject) || (ch == ']' && parent->nodeType == JATArray))
+						goto _closeNode;
+
+					m_iErr = ch == '}' || ch == ']' ? kErrorCloseNode : kErrorSymbol;
+					return 0;
+
+				_closeNode:
+					state = kStateCommaOrEnd;
+					if (-- m_nOpens == 0)
+						return pReadPos + 1;
+					break;
+				}
+			}
+
+			// ˽ڵ㶼ûйر
+			m_iErr = kErrorNotClosed;
+			return 0;
+		}
+
+		//룺һṹŻһֵֵݶνضʱNULL
+		char* feedToken(char* pReadPos)
+		{
+			uint8_t ch = pReadPos[0];
+			sfNodeBase* parent = m_nOpens ? m_nodeOpens[m_nOpens - 1] : NULL;
+
+			m_pLastPos = pReadPos;
+			switch (m_nPushState)
+			{
+			case kStateRoot:
+				if (ch == '[')
+				{
+					m_pRoot = openNode(JATArray, NULL);
+					m_nPushState = kStateValueOrEnd;
+				}
+				else if (ch == '{')
+				{
+					m_pRoot = openNode(JATObject, NULL);
+					m_nPushState = kStateNameOrEnd;
+				}
+				else
+				{
+					m_iErr = kErrorSymbol;
+					return 0;
+				}
+				return pReadPos + 1;
+
+			case kStateDone:
+				// ڵ֮ݺparseһԵ
+				return m_pMemEnd;
+
+			case kStateNameOrEnd:
+				if (ch == '}')
+					break;
+				// fall through
+			case kStateName:
+				if (ch != '"')
+				{
+					m_iErr = kErrorName;
+					return 0;
+				}
+				return feedString(pReadPos);
+
+			case kStateColon:
+				if (ch != ':')
+				{
+					m_iErr = kErrorSymbol;
+					return 0;
+				}
+				m_nPushState = kStateValue;
+				return pReadPos + 1;
+
+			case kStateValueOrEnd:
+				if (ch == ']')
+					break;
+				// fall through
+			case kStateValue:
+				if (ch == '{' || ch == '[')
+				{
+					if (m_nOpens == SFJ_MAX_PARSE_LEVEL)
+					{
+						m_iErr = kErrorMaxDeeps;
+						return 0;
+					}
+
+					uint32_t kAttr = ch == '{' ? JATObject : JATArray;
+					if (parent->nodeType == JATObject)
+						openNode(kAttr, m_pushName, parent);
+					else
+						openNode(kAttr, parent);
+
+					m_nPushState = ch == '{' ? kStateNameOrEnd : kStateValueOrEnd;
+					return pReadPos + 1;
+				}
+				if (ch == '"')
+					return feedString(pReadPos);
+				if (ch < 128 && ch != ',' && ch != ':' && ch != ']' && ch != '}')
+					return feedScalar(pReadPos);
+
+				m_iErr = kErrorSymbol;
+				return 0;
+
+			case kStateCommaOrEnd:
+				if (ch == ',')
+				{
+					m_nPushState = parent->nodeType == JATObject ? kStateName : kStateValue;
+					return pReadPos + 1;
+				}
+				if ((ch == '}' && parent->nodeType == JATObject) || (ch == ']' && parent->nodeType == JATArray))
+					break;
+
+				m_iErr = ch == '}' || ch == ']' ? kErrorCloseNode : kErrorSymbol;
+				return 0;
+			}
+
+			// رյǰڵ
+			m_nPushState = -- m_nOpens ? kStateCommaOrEnd : kStateDone;
+			return pReadPos + 1;
+		}
+
+		//룺ȡһֵַֻ
+		char* feedString(char* pReadPos)
+		{
+			bool bEscaped = false;
+			char* pEnd = findStringEnd(pReadPos + 1, bEscaped);
+			if (!pEnd)
+			{
+				savePartial(kPartialString, pReadPos, m_pMemEnd - pReadPos);
+				m_bPartialEscaped = bEscaped;
+				return 0;
+			}
+
+			if (!pushString(pReadPos, pEnd + 1 - pReadPos))
+				return 0;
+			return pEnd + 1;
+		}
+
+		//룺ȡһֵַ
+		char* feedScalar(char* pReadPos)
+		{
+			char* pEnd = findScalarEnd(pReadPos);
+			if (pEnd == m_pMemEnd)
+			{
+				savePartial(kPartialScalar, pReadPos, pEnd - pReadPos);
+				return 0;
+			}
+
+			// ֵ滹нֱݶת
+			bool bQuoteStart;
+			sfJSONString val;
+			pReadPos = parseFetchString(pReadPos, val, &bQuoteStart);
+			if (pReadPos && !pushValue(false, val))
+				return 0;
+
+			return pReadPos;
+		}
+
+		//룺һĩβضϵֵͱοͷ
+		char* feedPartial(char* pReadPos)
+		{
+			char* pEnd;
+			if (m_nPartialKind == kPartialString)
+			{
+				bool bEscaped = m_bPartialEscaped;
+				pEnd = findStringEnd(pReadPos, bEscaped);
+				if (!pEnd)
+				{
+					savePartial(kPartialString, pReadPos, m_pMemEnd - pReadPos);
+					m_bPartialEscaped = bEscaped;
+					return 0;
+				}
+
+				pEnd ++;
+				savePartial(kPartialString, pReadPos, pEnd - pReadPos);
+				m_nPartialKind = kPartialNone;
+
+				if (!pushString(m_pPartial, m_nPartial))
+					return 0;
+			}
+			else
+			{
+				pEnd = findScalarEnd(pReadPos);
+				savePartial(kPartialScalar, pReadPos, pEnd - pReadPos);
+				if (pEnd == m_pMemEnd)
+					return 0;
+
+				// һոΪת
+				savePartial(kPartialScalar, " ", 1);
+				m_nPartialKind = kPartialNone;
+
+				bool bQuoteStart;
+				sfJSONString val;
+				char* pSavedEnd = m_pMemEnd;
+
+				m_pMemEnd = m_pPartial + m_nPartial;
+				char* pValEnd = parseFetchString(m_pPartial, val, &bQuoteStart);
+				m_pMemEnd = pSavedEnd;
+
+				if (!pValEnd)
+					return 0;
+				if (pValEnd != m_pPartial + m_nPartial - 1)
+				{
+					m_iErr = kErrorValue;
+					return 0;
+				}
+
+				if (!pushValue(false, val))
+					return 0;
+			}
+
+			m_nPartial = 0;
+			m_pLastPos = pEnd;
+			return pEnd;
+		}
+
+		//룺һĴŵַƵm_strBufٽֵָֺƺڴ
+		bool pushString(const char* src, size_t len)
+		{
+			char* copy = m_strBuf.reserve(len);
+			memcpy(copy, src, len);
+
+			sfJSONString str;
+			char* pSavedEnd = m_pMemEnd;
+
+			m_pMemEnd = copy + len;
+			char* pReadPos = parseFetchString(copy, str);
+			m_pMemEnd = pSavedEnd;
+
+			if (!pReadPos)
+				return false;
+
+			if (m_nPushState == kStateName || m_nPushState == kStateNameOrEnd)
+			{
+				m_pushName = str;
+				m_nPushState = kStateColon;
+			}
+			else if (!pushValue(true, str))
+			{
+				return false;
+			}
+
+			return true;
+		}
+
+		// ʶֵ絥-deliverValueһΪkErrorValue
+		bool pushValue(bool bIsString, sfJSONString& val)
+		{
+			if (!bIsString && val.kType == JVTNone)
+			{
+				m_iErr = kErrorValue;
+				return false;
+			}
+
+			sfNodeBase* parent = m_nodeOpens[m_nOpens - 1];
+			sfNodeBase* n = addValueNode(bIsString, val, parent);
+			if (parent->nodeType == JATObject)
+				setName(n, m_pushName.pString, m_pushName.nLength);
+
+			m_nPushState = kStateCommaOrEnd;
+			return true;
+		}
+
+		void savePartial(uint32_t kind, const char* src, size_t len)
+		{
+			if (m_nPartial + len > m_nPartialSize)
+			{
+				m_nPartialSize = std::max(m_nPartialSize * 2, m_nPartial + len + 64);
+				m_pPartial = (char*)memRealloc(m_pPartial, m_nPartialSize);
+			}
+
+			memcpy(m_pPartial + m_nPartial, src, len);
+			m_nPartial += len;
+			m_nPartialKind = kind;
+		}
+
+		//δתţbEscapedʾpReadPos[0]Ƿѱһĩβķбת塣ûҵʱNULLbEscaped
+		char* findStringEnd(char* pReadPos, bool& bEscaped)
+		{
+			if (bEscaped)
+			{
+				if (pReadPos >= m_pMemEnd)
+					return 0;
+				pReadPos ++;
+				bEscaped = false;
+			}
+
+			while (pReadPos < m_pMemEnd)
+			{
+				pReadPos += findStringSpecial(pReadPos, m_pMemEnd - pReadPos);
+				if (pReadPos >= m_pMemEnd)
+					break;
+
+				if (pReadPos[0] != '\\')
+				{
+					// ţǻᱻparseFetchStringNULL
+					return pReadPos;
+				}
+
+				if (pReadPos + 1 >= m_pMemEnd)
+				{
+					bEscaped = true;
+					break;
+				}
+				pReadPos += 2;
+			}
+
+			return 0;
+		}
+
+		//ҷֵַĽλãûҵʱm_pMemEnd
+		inline char* findScalarEnd(char* pReadPos)
+		{
+			while (pReadPos < m_pMemEnd)
+			{
+				uint8_t ch = pReadPos[0];
+				if (ch < 128 && json_allends_allowed[ch])
+					break;
+				pReadPos ++;
+			}
+			return pReadPos;
+		}
+
+		//룺pReadPosʼһֵֵ֮λãʱNULLֻƥ䣬ڲ﷨
+		char* skipValue(char* pReadPos)
+		{
+			uint8_t ch = pReadPos[0];
+			if (ch == '"')
+			{
+				bool bEscaped = false;
+				char* pEnd = findStringEnd(pReadPos + 1, bEscaped);
+				if (pEnd && pEnd[0] == '"')
+					return pEnd + 1;
+
+				m_iErr = kErrorEnd;
+				return 0;
+			}
+
+			if (ch == '{' || ch == '[')
+			{
+				size_t n = StructIndex::matchBracket(pReadPos, m_pMemEnd - pReadPos);
+				if (n)
+					return pReadPos + n;
+
+				m_iErr = kErrorNotClosed;
+				return 0;
+			}
+
+			char* pEnd = findScalarEnd(pReadPos);
+			if (pEnd == pReadPos || pEnd >= m_pMemEnd)
+			{
+				m_iErr = pEnd == pReadPos ? kErrorValue : kErrorEnd;
+				return 0;
+			}
+			return pEnd;
+		}
+
+		//ӸλÿʼȡһֱַոΪֹ֧˫ַͷ˫ַ
+		char* parseFetchString(char* pReadPos, sfJSONString& str, bool* pbQuoteStart = NULL)
+		{
+			char* pStart = str.pString = pReadPos, *pEndPos = 0;
+			bool bQuoteStart = pStart[0] == '"';
+
+			if (pbQuoteStart)
+				*pbQuoteStart = bQuoteStart;
+			m_pLastPos = pReadPos;
+
+			if (bQuoteStart)
+			{
+				// ֵַ
+				pReadPos ++;
+				str.pString = pEndPos = pReadPos;
+
+				size_t i = findStringSpecial(pReadPos, m_pMemEnd - pReadPos);
+
+				pReadPos += i;
+				pEndPos = pReadPos;
+				if (pReadPos >= m_pMemEnd)
+				{
+					m_iErr = kErrorEnd;
+					return 0;
+				}
+
+				uint8_t ch = pReadPos[0];
+				if (ch == 0)
+				{
+					m_iErr = kErrorEnd;
+					return 0;
+				}
+
+				if (ch == '\\')
+				{
+					// ʱchΪ\˵ַкתţ˽תַĴ̡ĴֱӽֵַĻȡ
+					while (pReadPos < m_pMemEnd)
+					{
+						if (ch == '\\')
+						{
+							uint8_t next = json_unescape_chars[pReadPos[1]];
+							if (next == 0)
+							{
+								m_iErr = kErrorSymbol;
+								return 0;
+							}
+
+							if (next == 'u')
+							{
+								// UnicodeUTF8
+								uint32_t unicode = readUnicode(pReadPos + 2);
+								pEndPos = unicode2utf8(unicode, pEndPos);
+								pReadPos += 6;
+							}
+							else
+							{
+								*pEndPos ++ = next;
+								pReadPos += 2;
+							}
+						}
+						else if (ch == '"')
+						{
+							break;
+						}
+						else if (ch == 0)
+						{
+							m_iErr = kErrorEnd;
+							return 0;
+						}
+						else
+						{
+							// תַ֮ͨΰ
+							i = findStringSpecial(pReadPos, m_pMemEnd - pReadPos);
+							memmove(pEndPos, pReadPos, i);
+							pEndPos += i;
+							pReadPos += i;
+							if (pReadPos >= m_pMemEnd)
+								break;
+						}
+
+						ch = pReadPos[0];
+					}
+				}
+
+				if (pReadPos >= m_pMemEnd)
+				{
+					m_iErr = kErrorEnd;
+					return 0;
+				}
+			}
+			else
+			{
+				// ֵֵȴӵ1Ų²һ¿ʲô͵ֵ
+				sfJSONValueType kValType = JVTNone;
+				bool bNegativeVal = false;
+
+				uint8_t ch = pReadPos[0];
+				if (ch == '+')
+				{
+					pReadPos ++;
+					ch = pReadPos[0];
+				}
+				else if (ch == '-')
+				{
+					pReadPos ++;
+					ch = pReadPos[0];
+					bNegativeVal = true;
+				}
+
+				uint8_t ctl = json_value_char_tbl[ch];
+				if (ch == '0')
+				{
+					// 8ƻ16ƿ
+					pReadPos ++;
+					ch = pReadPos[0];
+					if (ch == 'x' || ch == 'X')
+					{
+						// ʮ
+						pReadPos ++;
+						kValType = JVTHex;
+						if (bNegativeVal)
+						{
+							m_iErr = kErrorValue;
+							return 0;
+						}
+					}
+					else if (ch == '.' || ch == 'e' || ch == 'E')
+					{
+						// С
+						kValType = JVTDouble;
+					}
+					else if ((uint8_t)(ch - '0') < 8)
+					{
+						// ˽
+						kValType = JVTOctal;
+					}
+					else
+					{
+						// 0ܽstrtoullĿհ׼
+						kValType = JVTDecimal;
+						str.i64 = 0;
+					}
+				}
+				else if (ctl == 1)
+				{
+					// ʮֿͷСһζȡ8֣߶תʱȷ
+					uint64_t u64 = 0;
+					size_t digits = 0;
+
+					while (m_pMemEnd - pReadPos >= 8)
+					{
+						uint64_t chunk;
+						memcpy(&chunk, pReadPos, 8);
+						if (!isEightDigits(chunk))
+							break;
+
+						u64 = u64 * 100000000 + parseEightDigits(chunk);
+						pReadPos += 8;
+						digits += 8;
+					}
+					while (pReadPos < m_pMemEnd && (uint8_t)(pReadPos[0] - '0') < 10)
+					{
+						u64 = u64 * 10 + (pReadPos[0] - '0');
+						pReadPos ++;
+						digits ++;
+					}
+
+					ch = pReadPos < m_pMemEnd ? pReadPos[0] : 0;
+					if (ch == '.' || ch == 'e' || ch == 'E' ||
+						digits > 19 || u64 > (bNegativeVal ? 0x8000000000000000ULL : 0x7FFFFFFFFFFFFFFFULL))
+					{
+						// С򳬳int64ΧС
+						kValType = JVTDouble;
+					}
+					else
+					{
+						kValType = JVTDecimal;
+						str.i64 = bNegativeVal ? (int64_t)(0 - u64) : (int64_t)u64;
+					}
+				}
+				else if (ctl >= 4 && ctl <= 7)
+				{
+					// ֵ
+					if (strncmp(pReadPos, "true", 4) == 0)
+					{
+						kValType = JVTTrue;
+						pReadPos += 4;
+					}
+					else if (strncmp(pReadPos, "false", 5) == 0)
+					{
+						kValType = JVTFalse;
+						pReadPos += 5;
+					}
+					else if (strncmp(pReadPos, "null", 4) == 0)
+					{
+						kValType = JVTNull;
+						pReadPos += 4;
+					}
+					else
+					{
+						m_iErr = kErrorValue;
+						return 0;
+					}
+
+					if (!json_allends_allowed[pReadPos[0]])
+					{
+						m_iErr = kErrorValue;
+						return 0;
+					}
+				}
+				else if (ch == '.')
+				{
+					// 
+					kValType = JVTDouble;
+				}
+
+				// תֵ
+				str.kType = kValType;
+				switch (kValType)
+				{
+				case JVTHex:
+					str.i64 = strtoull(pReadPos, &pReadPos, 16);
+					break;
+				case JVTOctal:
+					str.i64 = strtoull(pReadPos, &pReadPos, 8);
+					if (bNegativeVal)
+						str.i64 = -str.i64;
+					break;
+				case JVTDouble:
+					// ŷŴͷת
+#ifdef _SFJSON_CRTOPT_H__
+					pReadPos = pStart + opt_atod(pStart, m_pMemEnd - pStart, &str.dbl);
+#else
+					str.dbl = strtod(pStart, &pReadPos);
+#endif
+					if (pReadPos == pStart)
+					{
+						m_iErr = kErrorValue;
+						return 0;
+					}
+					break;
+				default:
+					// JVTDecimalʱѾתˣtrue/false/nullҪתJVTNoneɵ߱
+					break;
+				}
+
+				if (pReadPos >= m_pMemEnd)
+				{
+					m_iErr = kErrorEnd;
+					return 0;
+				}
+			}
+
+			str.nLength = (pEndPos ? pEndPos : pReadPos) - pStart;
+			if (bQuoteStart)
+			{
+				str.nLength --;
+				pReadPos ++;
+			}
+
+			return pReadPos;
+		}
+
+		//ȡLuaַ
+		char* parseFetchLuaString(char* pReadPos, uint32_t eqSyms, sfJSONString& str)
+		{
+			m_pLastPos = pReadPos;
+
+			char* src = pReadPos;
+			size_t i, k, ik, iend = m_pMemEnd - pReadPos - 2;
+			for (i = 0; i < iend; ++ i)
+			{
+				if (src[i] == ']')
+				{
+					for (k = 1; k < eqSyms; ++ k)
+					{
+						if (src[i + k] != '=')
+							break;
+					}
+
+					ik = i + k;
+					if (ik < iend && k - 1 == eqSyms && src[ik] == ']')
+					{
+						str.pString = src;
+						str.nLength = i;
+						return src + ik;
+					}
+				}
+			}
+
+			m_iErr = kErrorEnd;
+			return 0;
+		}
+
+	private:
+		static inline uint32_t readUnicode(const char* p)
+		{
+			uint32_t code = 0;
+			for (uint32_t i = 0, shift = 12; i < 4; ++ i, shift -= 4)
+			{
+				uint8_t ch = p[i];
+				switch (json_value_char_tbl[ch])
+				{
+				case 1: code |= (ch - '0') << shift; break;
+				case 4: code |= (ch - 'a' + 10) << shift; break;
+				case 6: code |= (ch - 'A' + 10) << shift; break;
+				}
+			}
+
+			return code;
+		}
+
+		static inline uint32_t unicode2utf8(uint32_t wchar)
+		{
+			if (wchar < 0xC0)
+				return 1;
+			if (wchar < 0x800)
+				return 2;
+			if (wchar < 0x10000)
+				return 3;
+			if (wchar < 0x200000)
+				return 4;
+
+			return 1;
+		}
+
+		static char* unicode2utf8(uint32_t _wchar, char *_utf8)
+		{
+			char *utf8 = _utf8;
+			uint32_t wchar = _wchar, len = 0;
+
+			if (wchar < 0xC0)
+			{
+				utf8[0] = (char)wchar;
+				len = 1;
+			}
+			else if (wchar < 0x800)
+			{
+				utf8[0] = 0xc0 | (wchar >> 6);
+				utf8[1] = 0x80 | (wchar & 0x3f);
+				len = 2;
+			}
+			else if (wchar < 0x10000)
+			{
+				utf8[0] = 0xe0 | (wchar >> 12);
+				utf8[1] = 0x80 | ((wchar >> 6) & 0x3f);
+				utf8[2] = 0x80 | (wchar & 0x3f);
+				len = 3;
+			}
+			else if (wchar < 0x200000)
+			{
+				utf8[0] = 0xf0 | ((int)wchar >> 18);
+				utf8[1] = 0x80 | ((wchar >> 12) & 0x3f);
+				utf8[2] = 0x80 | ((wchar >> 6) & 0x3f);
+				utf8[3] = 0x80 | (wchar & 0x3f);
+				len = 4;
+			}
+
+			return utf8 + len;
+		}
+	};
+}
+
+//////////////////////////////////////////////////////////////////////////
+class sfNode : public sfNodeBase
+{
+public:
+	typedef void(*fndefNodePrinted)(const char* code, size_t len, void* user);
+	static void fnNodePrintToString(const char* code, size_t len, void* user)
+	{
+		std::string* str = (std::string*)user;
+		if (code)
+			str->append(code, len);
+		else
+			str->reserve(len);
+	}
+#ifdef _WINDOWS
+	// userָļдʧʱΪ-1
+	static void fnNodePrintToFd(const char* code, size_t len, void* user)
+	{
+		int* fd = (int*)user;
+		while (code && len > 0 && *fd >= 0)
+		{
+			int r = _write(*fd, code, (unsigned int)std::min(len, (size_t)0x40000000));
+			if (r <= 0)
+			{
+				*fd = -1;
+				break;
+			}
+			code += r;
+			len -= r;
+		}
+	}
+#else
+	// writevдݶΣжϺֻдһֵ
+	static bool fnNodePrintToFd(const struct iovec* iov, int count, size_t, void* user)
+	{
+		int fd = *(int*)user;
+		struct iovec part;
+		bool bPart = false;
+
+		while (count > 0)
+		{
+			int cc = std::min(count, IOV_MAX);
+			ssize_t r = bPart ? writev(fd, &part, 1) : writev(fd, iov, cc);
+			if (r < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				return false;
+			}
+
+			// ѾдݶΣʣһûдĵд
+			size_t written = (size_t)r;
+			if (bPart)
+			{
+				if (written < part.iov_len)
+				{
+					part.iov_base = (char*)part.iov_base + written;
+					part.iov_len -= written;
+					continue;
+				}
+				bPart = false;
+				iov ++;
+				count --;
+				continue;
+			}
+
+			while (count > 0 && written >= iov->iov_len)
+			{
+				written -= iov->iov_len;
+				iov ++;
+				count --;
+			}
+			if (written > 0)
+			{
+				part.iov_base = (char*)iov->iov_base + written;
+				part.iov_len = iov->iov_len - written;
+				bPart = true;
+			}
+		}
+
+		return true;
+	}
+#endif
+
+public:
+	// ΪӽڵﵽSFJ_FIND_INDEX_MINĶֵĹϣ齨ӽڵָbRecursiveΪtrueʱеڵ
+	// find/findKey/indexὨbuildIndexaddһ޸ĵҪĵ̲֮߳ǰ
+	sfNode* buildIndex(bool bRecursive = true)
+	{
+		if (!pFile)
+			return this;
+
+		indexChildren();
+		if (!bRecursive)
+			return this;
+
+		// ȣÿһֻһҪֵܽڵ㣬SFJ_MAX_PARSE_LEVELĲ֣õĵôʱȽ
+		sfNode* stack[SFJ_MAX_PARSE_LEVEL];
+		size_t depth = 0;
+		sfNode* c = child;
+
+		for ( ; ; )
+		{
+			while (c && ((c->nodeType != JATObject && c->nodeType != JATArray) || !c->child))
+				c = c->next;
+
+			if (c)
+			{
+				c->indexChildren();
+				if (depth < SFJ_MAX_PARSE_LEVEL)
+				{
+					stack[depth ++] = c->next;
+					c = c->child;
+				}
+				else
+					c = c->next;
+				continue;
+			}
+
+			if (!depth)
+				break;
+			c = stack[-- depth];
+		}
+
+		return this;
+	}
+
+	// ֲңͬӽڵʱصһ
+	inline sfNode* find(const char* str) const
+	{
+		return find(str, strlen(str));
+	}
+	// ֲҡѾbuildIndex˹ϣʱңȽϡaddͬʱӽڵҪ޸
+	// Ҳ޸ĵ߳̿ͬʱͬһĵв
+	sfNode* find(const char* str, size_t len) const
+	{
+		if (nodeType == JATObject && childIndex)
+		{
+			uint32_t mask = valLength - 1;
+			uint32_t i = sfjson::hashName(str, len) & mask;
+			sfNode* n;
+			while ((n = childIndex[i]) != NULL)
+			{
+				if (n->nameLength == len && memcmp(n->nameKey, str, len) == 0)
+					return n;
+				i = (i + 1) & mask;
+			}
+			return NULL;
+		}
+
+		sfNode* n = child;
+		while (n)
+		{
+			if (n->nameLength == len && memcmp(n->nameKey, str, len) == 0)
+				return n;
+			n = n->next;
+		}
+		return NULL;
+	}
+#ifdef SFJ_CXX11
+	// ֱеֲңkeysfJsonKeys::internصָ롣ʱʹͬһֱģֻҪȽָ
+	sfNode* findKey(const char* key) const
+	{
+		const sfjson::KeyTable::Key* k = sfjson::KeyTable::keyOf(key);
+		uint32_t len = k->length;
+
+		if (nodeType == JATObject && childIndex)
+		{
+			uint32_t mask = valLength - 1;
+			uint32_t i = k->hash & mask;
+			sfNode* n;
+			while ((n = childIndex[i]) != NULL)
+			{
+				if (n->nameKey == key || (n->nameLength == len && memcmp(n->nameKey, key, len) == 0))
+					return n;
+				i = (i + 1) & mask;
+			}
+			return NULL;
+		}
+
+		// ֱʱµֱֲʱӵҲֱУָ벻ͬʱҪݱȽ
+		for (sfNode* n = child; n; n = n->next)
+		{
+			if (n->nameKey == key || (n->nameLength == len && memcmp(n->nameKey, key, len) == 0))
+				return n;
+		}
+		return NULL;
+	}
+#endif
+	// ȡ0ʼѾbuildIndexӽڵָʱǳʱ䣬֮addͬʱָ
+	sfNode* index(uint32_t index) const
+	{
+		if (index >= childCount)
+			return NULL;
+
+		if (nodeType == JATArray && childIndex)
+			return childIndex[index];
+
+		sfNode* n = child;
+		for (uint32_t i = 0; i < index && n; ++ i)
+			n = n->next;
+		return n;
+	}
+	// ȡ0ʼ
+	inline sfNode* operator [] (uint32_t i) const
+	{
+		return index(i);
+	}
+
+	// ӽڵǰnextԱʣͬʱԤȡһڵ
+	class iterator
+	{
+	public:
+		typedef std::forward_iterator_tag	iterator_category;
+		typedef sfNode*						value_type;
+		typedef ptrdiff_t					difference_type;
+		typedef sfNode**					pointer;
+		typedef sfNode*&					reference;
+
+		inline iterator(sfNode* n = NULL) : m_pNode(n) {}
+
+		inline sfNode* operator * () const { return m_pNode; }
+		inline sfNode* operator -> () const { return m_pNode; }
+		inline iterator& operator ++ ()
+		{
+			m_pNode = m_pNode->next;
+			if (m_pNode)
+				SFJ_PREFETCH(m_pNode->next);
+			return *this;
+		}
+		inline iterator operator ++ (int) { iterator r(*this); ++ *this; return r; }
+
+		inline bool operator == (const iterator& r) const { return m_pNode == r.m_pNode; }
+		inline bool operator != (const iterator& r) const { return m_pNode != r.m_pNode; }
+
+	private:
+		sfNode		*m_pNode;
+	};
+	typedef iterator const_iterator;
+
+	inline iterator begin() const { return iterator(child); }
+	inline iterator end() const { return iterator(); }
+
+	// һսڵ
+	sfNode* createObject(const char* name = NULL, size_t len = 0)
+	{
+		sfjson::JFile* p = (sfjson::JFile*)pFile;
+
+		sfNode* n = (sfNode*)p->m_nodesPool.allocate();
+		memset(n, 0, sizeof(sfNode));
+
+		n->nodeType = JATObject;
+		n->pFile = pFile;
+
+		if (name)
+			n->name(name, len);
+
+		return n;
+	}
+	// һ
+	sfNode* createArray()
+	{
+		sfjson::JFile* p = (sfjson::JFile*)pFile;
+
+		sfNode* n = (sfNode*)p->m_nodesPool.allocate();
+		memset(n, 0, sizeof(sfNode));
+
+		n->nodeType = JATArray;
+		n->pFile = pFile;
+
+		return n;
+	}
+	// һֵ
+	sfNode* createValue()
+	{
+		sfjson::JFile* p = (sfjson::JFile*)pFile;
+
+		sfNode* n = (sfNode*)p->m_nodesPool.allocate();
+		memset(n, 0, sizeof(sfNode));
+
+		n->pFile = pFile;
+
+		return n;
+	}
+
+	// Ϊڵ㴴һڵ㣬ڵӽȥ
+	sfNode* createParentObject(const char* name, size_t len = 0)
+	{
+		sfjson::JFile* p = (sfjson::JFile*)pFile;
+
+		sfNode* n = (sfNode*)p->m_nodesPool.allocate();
+		memset(n, 0, sizeof(sfNode));
+
+		n->nodeType = JATObject;
+		n->pFile = pFile;
+
+		// ӣڵ㽨ʱaddҪ
+		if (name)
+			this->name(name, len);
+		n->add(this);
+
+		return n;
+	}
+	// һ
+	sfNode* createParentArray()
+	{
+		sfjson::JFile* p = (sfjson::JFile*)pFile;
+
+		sfNode* n = (sfNode*)p->m_nodesPool.allocate();
+		memset(n, 0, sizeof(sfNode));
+
+		n->nodeType = JATArray;
+		n->pFile = pFile;
+		n->add(this);
+
+		return n;
+	}
+
+	// һѾõĽڵӵڵ³Ϊӽڵ㲢thisʱnҪú
+	sfNode* add(sfNode* n)
+	{
+		childCount ++;
+		if (child)
+			childLast->next = n;
+		else
+			child = n;
+		childLast = n;
+
+		if (childIndex)
+		{
+			if (nodeType == JATObject)
+				addToIndex(n);
+			else
+				addToVector(n);
+		}
+
+		return this;
+	}
+	// һѾõĽڵӵڵ³Ϊӽڵ㲢ֺ󷵻this
+	sfNode* add(sfNode* n, const char* name, size_t len = 0)
+	{
+		n->name(name, len);
+		return add(n);
+	}
+
+	// ýڵ
+	sfNode* name(const char* name, size_t len = 0)
+	{
+		if (name)
+		{
+			sfjson::JFile* p = (sfjson::JFile*)pFile;
+			nameLength = len ? len : strlen(name);
+			// reserve֤ģaddStringڴĩβַ
+			nameKey = p->m_strBuf.reserve(nameLength + 1);
+			memcpy(nameKey, name, nameLength);
+			nameKey[nameLength] = 0;
+		}
+
+		return this;
+	}
+
+	// ñڵֵΪ
+	sfNode* val(bool val)
+	{
+		assert(nodeType < JATObject);
+
+		if (nodeType < JATObject)
+		{
+			bval = val;
+			valLength = -1;
+			nodeType = JATBooleanValue;
+		}
+		return this;
+	}
+	// ñڵֵΪ
+	sfNode* val(int64_t val)
+	{
+		assert(nodeType < JATObject);
+
+		if (nodeType < JATObject)
+		{
+			ival = val;
+			valLength = -1;
+			nodeType = JATIntValue;
+		}
+		return this;
+	}
+	sfNode* val(int val)
+	{
+		assert(nodeType < JATObject);
+
+		if (nodeType < JATObject)
+		{
+			ival = val;
+			valLength = -1;
+			nodeType = JATIntValue;
+		}
+		return this;
+	}
+	// ñڵֵΪС
+	sfNode* val(double val)
+	{
+		assert(nodeType < JATObject);
+
+		if (nodeType < JATObject)
+		{
+			dval = val;
+			valLength = -1;
+			nodeType = JATDoubleValue;
+		}
+		return this;
+	}
+	// ñڵֵΪֵַ͡Ϊnullڵ
+	sfNode* val(const char* val = NULL, size_t len = 0)
+	{
+		assert(nodeType < JATObject);
+
+		if (nodeType < JATObject)
+		{
+			sfjson::JFile* p = (sfjson::JFile*)pFile;
+			if (val)
+			{
+				nodeType = JATString;
+				valLength = len ? len : strlen(val);
+				strval = p->m_strBuf.reserve(valLength + 1);
+				memcpy(strval, val, valLength);
+				strval[valLength] = 0;
+			}
+			else
+			{
+				strval = NULL;
+				valLength = -1;
+				nodeType = JATNullValue;
+			}
+		}
+		return this;
+	}
+
+	// Сתͣͷ0
+	inline double toDouble() const
+	{
+		if (nodeType == JATDoubleValue)
+			return dval;
+		if (nodeType == JATIntValue || nodeType == JATBooleanValue)
+			return ival;
+		return 0;
+	}
+	// Сתͣͷ0
+	inline int64_t toInteger() const
+	{
+#define D2I_ENDIALOC	0
+
+		if (nodeType == JATIntValue || nodeType == JATBooleanValue)
+			return ival;
+		if (nodeType == JATDoubleValue)
+		{
+			union d2int
+			{
+				double	dval;
+				int32_t	i32[2];
+			} u;
+
+			u.dval = dval + 6755399441055744.0;
+			return u.i32[D2I_ENDIALOC];
+		}
+		return 0;
+	}
+	// תַ
+	void toString(std::string& strOut) const
+	{
+		sfjson::valueToString(sfjson::TreeNodes(), this, strOut);
+	}
+
+	// ֱӻȡС
+	template <typename R> R toInt() const
+	{
+		return (R)ival;
+	}
+
+	// ʽΪַ׷ӵstrOutĩβֱдֶַεı뻺ٸһ
+	// õĵʱȰԴݵĳresizeӽڵ㡢ͽ߳򹹽ĵSFJ_ENCODE_INIT_MEMSIZEʼ
+	// ռ䲻ʱȳɱҪѾдݣresizeҲĲ0Ҫ׼ȷһʱprintSizeõprintToMemory
+	// 㳤Ҫнڵٱһ飬ʱͱ࣬ﲻȼ
+	bool printTo(std::string& strOut, uint32_t flags = kJsonUnicodes)
+	{
+		if (nodeType != JATObject && nodeType != JATArray)
+			return false;
+
+		sfjson::JFile* p = (sfjson::JFile*)pFile;
+		sfjson::StringBuffer buf(strOut, p->m_pRoot == this ? std::max(p->m_nMemSize + 2, (size_t)SFJ_ENCODE_INIT_MEMSIZE) : SFJ_ENCODE_INIT_MEMSIZE);
+		buf.addChar(nodeType == JATObject ? '{' : '[');
+		printChildren(buf, flags);
+		buf.addChar(nodeType == JATObject ? '}' : ']');
+		buf.finish();
+
+		return true;
+	}
+
+	// ʽ׼ȷȣβţڵ㲻Ƕʱ0
+	size_t printSize(uint32_t flags = kJsonUnicodes)
+	{
+		if (nodeType != JATObject && nodeType != JATArray)
+			return 0;
+
+		sfjson::SizeCounter counter;
+		printChildren(counter, flags);
+		return counter.total + 2;
+	}
+
+	// ʽṩڴУӽβ0ҪĳȣbufSizeСʱдκ
+	// ڵ㲻Ƕʱ0
+	size_t printToMemory(char* buf, size_t bufSize, uint32_t flags = kJsonUnicodes)
+	{
+		size_t len = printSize(flags);
+		if (len && len <= bufSize)
+			encodeFlat(buf, flags);
+		return len;
+	}
+
+#ifndef _WINDOWS
+	// ݶΣβţһνصݶֱָ뻺壬ûм临ƣֱwritev/sendmsg
+	// iovֻڻصЧػصķֵ
+	typedef bool(*fndefNodePrintedIovec)(const struct iovec* iov, int count, size_t total, void* user);
+	bool printToIovec(fndefNodePrintedIovec fn, void* user, uint32_t flags = kJsonUnicodes)
+	{
+		char fixbuf[SFJ_ENCODE_INIT_MEMSIZE];
+		sfjson::MemList encodeBuf;
+		char brackets[2];
+		size_t total;
+
+		encodeBuf.wrapNode(fixbuf, sizeof(fixbuf));
+		if (!encodeChildren(encodeBuf, brackets[0], total, flags))
+			return false;
+		brackets[1] = brackets[0] == '{' ? '}' : ']';
+
+		int count = 2;
+		sfjson::MemNode* n;
+		for (n = encodeBuf.first; n; n = n->next)
+			count ++;
+
+		struct iovec* iov = (struct iovec*)sfjson::memAlloc(count * sizeof(struct iovec));
+		iov[0].iov_base = brackets;
+		iov[0].iov_len = 1;
+
+		count = 1;
+		for (n = encodeBuf.first; n; n = n->next)
+		{
+			if (n->used)
+			{
+				iov[count].iov_base = (char*)(n + 1);
+				iov[count ++].iov_len = n->used;
+			}
+		}
+		iov[count].iov_base = brackets + 1;
+		iov[count ++].iov_len = 1;
+
+		bool r = fn(iov, count, total + 2, user);
+		sfjson::memFree(iov);
+
+		return r;
+	}
+#endif
+
+	// ֱдļļܵsocketLinuxϵͳwritevһдݶ
+	bool printToFd(int fd, uint32_t flags = kJsonUnicodes)
+	{
+#ifdef _WINDOWS
+		int fdUser = fd;
+		return printTo(fnNodePrintToFd, &fdUser, flags) && fdUser >= 0;
+#else
+		return printToIovec(fnNodePrintToFd, &fd, flags);
+#endif
+	}
+
+	// дļȰܳļСٰļӳ䵽ڴθݶΣʺдܴĵ
+	bool printToFile(const char* path, uint32_t flags = kJsonUnicodes)
+	{
+		char fixbuf[SFJ_ENCODE_INIT_MEMSIZE];
+		sfjson::MemList encodeBuf;
+		char beginChar;
+		size_t total;
+
+		encodeBuf.wrapNode(fixbuf, sizeof(fixbuf));
+		if (!encodeChildren(encodeBuf, beginChar, total, flags))
+			return false;
+		total += 2;
+
+		char* dst = NULL;
+#ifdef _WINDOWS
+		HANDLE hFile = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (hFile == INVALID_HANDLE_VALUE)
+			return false;
+
+		HANDLE hMap = CreateFileMappingA(hFile, NULL, PAGE_READWRITE, (DWORD)((uint64_t)total >> 32), (DWORD)total, NULL);
+		if (hMap)
+		{
+			dst = (char*)MapViewOfFile(hMap, FILE_MAP_WRITE, 0, 0, total);
+			CloseHandle(hMap);
+		}
+		CloseHandle(hFile);
+#else
+		int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0)
+			return false;
+
+		if (ftruncate(fd, (off_t)total) == 0)
+		{
+			void* m = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if (m != MAP_FAILED)
+			{
+				madvise(m, total, MADV_SEQUENTIAL);
+				dst = (char*)m;
+			}
+		}
+		close(fd);
+#endif
+		if (!dst)
+			return false;
+
+		char* pos = dst;
+		*pos ++ = beginChar;
+		for (sfjson::MemNode* n = encodeBuf.first; n; n = n->next)
+		{
+			memcpy(pos, (char*)(n + 1), n->used);
+			pos += n->used;
+		}
+		*pos = beginChar == '{' ? '}' : ']';
+
+#ifdef _WINDOWS
+		UnmapViewOfFile(dst);
+#else
+		munmap(dst, total);
+#endif
+		return true;
+	}
+
+	bool printTo(fndefNodePrinted fn, void* user, uint32_t flags = kJsonUnicodes)
+	{
+		char fixbuf[SFJ_ENCODE_INIT_MEMSIZE];
+		sfjson::MemList encodeBuf;
+		char beginChar;
+		size_t total;
+
+		encodeBuf.wrapNode(fixbuf, sizeof(fixbuf));
+		if (!encodeChildren(encodeBuf, beginChar, total, flags))
+			return false;
+
+		if (fn)
+		{
+			fn(NULL, total + 2, user);
+			fn(&beginChar, 1, user);
+
+			// ϲ
+			sfjson::MemNode* n = encodeBuf.first;
+			while (n)
+			{
+				fn((char*)(n + 1), n->used, user);
+				n = n->next;
+			}
+
+			beginChar = beginChar == '{' ? '}' : ']';
+			fn(&beginChar, 1, user);
+		}
+
+		return true;
+	}
+
+	// 
+	void destroy()
+	{
+		if (pFile)
+		{
+			sfjson::JFile* p = (sfjson::JFile*)pFile;
+			bool bExternal = p->m_bExternal;
+			p->~JFile();
+			if (!bExternal)
+				sfjson::memFree(p);
+		}
+	}
+
+public:// ʽ
+	   // ֵͽڵͬʱΪӽڵ㲢رڵ㣨Ǹմӽڵ㣩
+	inline sfNode* append(bool val)
+	{
+		addValue()->val(val);
+		return this;
+	}
+	// ֵͽڵͬʱΪӽڵ㲢رڵ㣨Ǹմӽڵ㣩
+	inline sfNode* append(int64_t val)
+	{
+		addValue()->val(val);
+		return this;
+	}
+	inline sfNode* append(int val)
+	{
+		addValue()->val(val);
+		return this;
+	}
+	// ֵͽڵͬʱΪӽڵ㲢رڵ㣨Ǹմӽڵ㣩
+	inline sfNode* append(double val)
+	{
+		addValue()->val(val);
+		return this;
+	}
+	// ֵͽڵͬʱΪӽڵ㲢رڵ㣨Ǹմӽڵ㣩
+	inline sfNode* append(const char* val = NULL, size_t len = 0)
+	{
+		addValue()->val(val, len);
+		return this;
+	}
+
+	// ֵͽڵͬʱΪӽڵ㲢رڵ㣨Ǹմӽڵ㣩
+	inline sfNode* appendNamed(const char* name, bool val)
+	{
+		add(createValue()->val(val), name);
+		return this;
+	}
+	// ֵͽڵͬʱΪӽڵ㲢رڵ㣨Ǹմӽڵ㣩
+	inline sfNode* appendNamed(const char* name, int64_t val)
+	{
+		add(createValue()->val(val), name);
+		return this;
+	}
+	inline sfNode* appendNamed(const char* name, int val)
+	{
+		add(createValue()->val(val), name);
+		return this;
+	}
+	// ֵͽڵͬʱΪӽڵ㲢رڵ㣨Ǹմӽڵ㣩
+	inline sfNode* appendNamed(const char* name, double val)
+	{
+		add(createValue()->val(val), name);
+		return this;
+	}
+	// ֵͽڵͬʱΪӽڵ㲢رڵ㣨Ǹմӽڵ㣩
+	inline sfNode* appendNamed(const char* name, const char* val = NULL, size_t len = 0)
+	{
+		add(createValue()->val(val, len), name);
+		return this;
+	}
+
+	// ֵ͵Ľڵ
+	inline sfNode* createValue(bool val)
+	{
+		return createValue()->val(val);
+	}
+	inline sfNode* createValue(int64_t val)
+	{
+		return createValue()->val(val);
+	}
+	inline sfNode* createValue(double val)
+	{
+		return createValue()->val(val);
+	}
+	inline sfNode* createValue(const char* val, size_t len = 0)
+	{
+		return createValue()->val(val, len);
+	}
+
+	// ڵͬʱΪӽڵ㲢ظմĽڵ
+	inline sfNode* addObject(const char* name = NULL, size_t len = 0)
+	{
+		sfNode* n = createObject(name, len); 
+		add(n);
+		return n;
+	}
+	// ͬʱΪӽڵ㲢ظմĽڵ
+	inline sfNode* addArray(const char* name = NULL, size_t len = 0)
+	{
+		sfNode* n = createArray(); 
+		if (name) n->name(name, len);
+		add(n);
+		return n;
+	}
+
+	// ֵͬʱΪӽڵ㲢ظմĽڵ
+	inline sfNode* addValue() { sfNode* n = createValue(); add(n); return n; }
+
+	// ֵͬʱΪӽڵ㲢ֵֵ󣬷ظմĽڵ
+	inline sfNode* addValue(bool val) { sfNode* n = createValue()->val(val); add(n); return n; }
+	inline sfNode* addValue(int64_t val) { sfNode* n = createValue()->val(val); add(n); return n; }
+	inline sfNode* addValue(double val) { sfNode* n = createValue()->val(val); add(n); return n; }
+	inline sfNode* addValue(const char* val, size_t len = 0) { sfNode* n = createValue()->val(val, len); add(n); return n; }
+
+private:
+	// ӽڵ뵽encodeBufУβţtotalΪĳȡڵ㲻Ƕʱfalse
+	bool encodeChildren(sfjson::MemList& encodeBuf, char& beginChar, size_t& total, uint32_t flags)
+	{
+		switch (nodeType)
+		{
+		case JATObject: beginChar = '{'; break;
+		case JATArray: beginChar = '['; break;
+		default: return false;
+		}
+
+		printChildren(encodeBuf, flags);
+
+		// ͳ
+		total = 0;
+		for (sfjson::MemNode* n = encodeBuf.first; n; n = n->next)
+			total += n->used;
+
+		return true;
+	}
+
+	// αӽڵ㣬öŷָ
+	template <typename Buf> inline void printChildren(Buf& buf, uint32_t flags)
+	{
+		sfjson::printMembers(buf, sfjson::TreeNodes(), this, flags);
+	}
+
+	// 뵽dstdstҪprintSize()ôĿռ
+	void encodeFlat(char* dst, uint32_t flags)
+	{
+		sfjson::FlatBuffer buf(dst);
+		buf.addChar(nodeType == JATObject ? '{' : '[');
+		printChildren(buf, flags);
+		buf.addChar(nodeType == JATObject ? '}' : ']');
+	}
+
+	// ӽڵﵽSFJ_FIND_INDEX_MINʱΪڵ㽨
+	inline void indexChildren()
+	{
+		if (!childIndex && childCount >= SFJ_FIND_INDEX_MIN)
+		{
+			if (nodeType == JATObject)
+				createIndex(childCount * 2);
+			else if (nodeType == JATArray)
+				createVector(childCount * 2);
+		}
+	}
+
+	// ֵĹϣΪ2ӽڵ2ڴĵַз䡣ֻͬһ
+	void createIndex(uint32_t minSlots)
+	{
+		uint32_t slots = 32;
+		while (slots < minSlots)
+			slots <<= 1;
+
+		sfjson::JFile* p = (sfjson::JFile*)pFile;
+		childIndex = (sfNode**)p->m_strBuf.reserveAligned(slots * sizeof(sfNode*));
+		memset(childIndex, 0, slots * sizeof(sfNode*));
+		valLength = slots;
+
+		for (sfNode* n = child; n; n = n->next)
+			insertIndex(n);
+	}
+	void addToIndex(sfNode* n)
+	{
+		if (childCount * 2 > valLength)
+			createIndex(childCount * 2);
+		else
+			insertIndex(n);
+	}
+	void insertIndex(sfNode* n)
+	{
+		if (!n->nameKey)
+			return;
+
+		uint32_t mask = valLength - 1;
+		uint32_t i = sfjson::hashName(n->nameKey, n->nameLength) & mask;
+		sfNode* c;
+		while ((c = childIndex[i]) != NULL)
+		{
+			if (c->nameLength == n->nameLength && memcmp(c->nameKey, n->nameKey, n->nameLength) == 0)
+				return;
+			i = (i + 1) & mask;
+		}
+		childIndex[i] = n;
+	}
+
+	// ӽڵָڴĵַз
+	void createVector(uint32_t minSlots)
+	{
+		uint32_t slots = 32, i = 0;
+		while (slots < minSlots)
+			slots <<= 1;
+
+		sfjson::JFile* p = (sfjson::JFile*)pFile;
+		childIndex = (sfNode**)p->m_strBuf.reserveAligned(slots * sizeof(sfNode*));
+		valLength = slots;
+
+		for (sfNode* n = child; n; n = n->next)
+			childIndex[i ++] = n;
+	}
+	// ʱ2·䣬ɵַָĵһͷ
+	void addToVector(sfNode* n)
+	{
+		if (childCount > valLength)
+		{
+			sfjson::JFile* p = (sfjson::JFile*)pFile;
+			sfNode** old = childIndex;
+
+			valLength *= 2;
+			childIndex = (sfNode**)p->m_strBuf.reserveAligned(valLength * sizeof(sfNode*));
+			memcpy(childIndex, old, (childCount - 1) * sizeof(sfNode*));
+		}
+		childIndex[childCount - 1] = n;
+	}
+};
+
+//////////////////////////////////////////////////////////////////////////
+// α
+/*
+ * ֱJsonԴ϶λֻ·ϵĲ֣·Ķֻƥκνڵ㡣ʺϴӴĵֻȡֶεĳ
+ * Դ벻ᱻ޸ģsfJsonLazyDocڱһֱЧ
+ *
+ *   sfJsonLazyDoc doc(jsonString, stringLength);
+ *   sfJsonCursor c = doc.root().find("user").find("name");
+ *   if (c.isValid()) c.toString(str);
+ *
+ * ͬһαfind/indexͷɨ裬Ҫ˳ȡԱʱӦʹsfJsonDecode
+ */
+class sfJsonCursor
+{
+	friend class sfJsonLazyDoc;
+public:
+	inline sfJsonCursor() : m_pFile(NULL), m_pValue(NULL) {}
+
+	// ûҵ߽ʱαЧЧαвЧα0
+	inline bool isValid() const { return m_pValue != NULL; }
+
+	// ֵͣsfNodeValueTypeֵҪС
+	uint32_t type() const
+	{
+		if (!m_pValue)
+			return JATNullValue;
+
+		switch (m_pValue[0])
+		{
+		case '{': return JATObject;
+		case '[': return JATArray;
+		case '"': return JATString;
+		}
+
+		sfjson::sfJSONString val;
+		if (!fetchScalar(val))
+			return JATNullValue;
+		if (val.kType == sfjson::JVTDouble)
+			return JATDoubleValue;
+		if (val.kType == sfjson::JVTTrue || val.kType == sfjson::JVTFalse)
+			return JATBooleanValue;
+		if (val.kType == sfjson::JVTNull)
+			return JATNullValue;
+		return JATIntValue;
+	}
+
+	// ڶаֲҳԱlenΪ0ʱʹstrlenֳ
+	sfJsonCursor find(const char* key, size_t len = 0) const
+	{
+		sfJsonCursor r;
+		if (!m_pValue || m_pValue[0] != '{')
+			return r;
+
+		if (len == 0)
+			len = strlen(key);
+
+		sfjson::JFile* f = m_pFile;
+		char* pReadPos = f->skipWhites(m_pValue + 1);
+		if (pReadPos && pReadPos < f->m_pMemEnd && pReadPos[0] == '}')
+			return r;
+
+		while (pReadPos && pReadPos < f->m_pMemEnd)
+		{
+			if (pReadPos[0] != '"')
+			{
+				f->m_iErr = sfjson::JFile::kErrorName;
+				break;
+			}
+
+			char* pValue = fetchKey(pReadPos, key, len, r);
+			if (!pValue)
+				break;
+			if (r.m_pValue)
+				return r;
+
+			pReadPos = f->skipValue(pValue);
+			if (!(pReadPos = nextSibling(pReadPos, '}')))
+				break;
+		}
+
+		return r;
+	}
+
+	// аȡ0ʼ·Ԫ
+	sfJsonCursor index(uint32_t index) const
+	{
+		sfJsonCursor r;
+		if (!m_pValue || m_pValue[0] != '[')
+			return r;
+
+		sfjson::JFile* f = m_pFile;
+		char* pReadPos = f->skipWhites(m_pValue + 1);
+		if (!pReadPos || pReadPos >= f->m_pMemEnd || pReadPos[0] == ']')
+			return r;
+
+		for (uint32_t i = 0; ; ++ i)
+		{
+			if (i == index)
+			{
+				r.m_pFile = f;
+				r.m_pValue = pReadPos;
+				break;
+			}
+
+			pReadPos = f->skipValue(pReadPos);
+			if (!(pReadPos = nextSibling(pReadPos, ']')))
+				break;
+		}
+
+		return r;
+	}
+	inline sfJsonCursor operator [] (uint32_t i) const { return index(i); }
+
+	// ĳԱҪɨ
+	uint32_t count() const
+	{
+		if (!m_pValue || (m_pValue[0] != '{' && m_pValue[0] != '['))
+			return 0;
+
+		sfjson::JFile* f = m_pFile;
+		char ends = m_pValue[0] == '{' ? '}' : ']';
+		char* pReadPos = f->skipWhites(m_pValue + 1);
+		if (!pReadPos || pReadPos >= f->m_pMemEnd || pReadPos[0] == ends)
+			return 0;
+
+		uint32_t cc = 0;
+		while (pReadPos)
+		{
+			if (ends == '}')
+			{
+				// ֺð
+				pReadPos = f->skipValue(pReadPos);
+				if (pReadPos)
+					pReadPos = f->skipWhites(pReadPos);
+				if (!pReadPos || pReadPos >= f->m_pMemEnd || pReadPos[0] != ':')
+					break;
+				pReadPos = f->skipWhites(pReadPos + 1);
+				if (!pReadPos || pReadPos >= f->m_pMemEnd)
+					break;
+			}
+
+			cc ++;
+			pReadPos = f->skipValue(pReadPos);
+			pReadPos = nextSibling(pReadPos, ends);
+		}
+
+		return cc;
+	}
+
+	// Сתͣͷ0
+	double toDouble() const
+	{
+		sfjson::sfJSONString val;
+		if (!fetchScalar(val))
+			return 0;
+		if (val.kType == sfjson::JVTDouble)
+			return val.dbl;
+		if (val.kType == sfjson::JVTTrue)
+			return 1;
+		if (val.kType == sfjson::JVTFalse || val.kType == sfjson::JVTNull)
+			return 0;
+		return (double)val.i64;
+	}
+	// Сתͣͷ0
+	int64_t toInteger() const
+	{
+		sfjson::sfJSONString val;
+		if (!fetchScalar(val))
+			return 0;
+		if (val.kType == sfjson::JVTDouble)
+			return (int64_t)val.dbl;
+		if (val.kType == sfjson::JVTTrue)
+			return 1;
+		if (val.kType == sfjson::JVTFalse || val.kType == sfjson::JVTNull)
+			return 0;
+		return val.i64;
+	}
+	inline bool isNull() const { return m_pValue && m_pValue[0] == 'n'; }
+
+	// ֵַת׷ӵstrOutֵԴԭ׷ӣ鼴ΪJson룩
+	void toString(std::string& strOut) const
+	{
+		if (!m_pValue)
+			return;
+
+		sfjson::JFile* f = m_pFile;
+		if (m_pValue[0] == '"')
+		{
+			bool bEscaped = false;
+			char* pEnd = f->findStringEnd(m_pValue + 1, bEscaped);
+			if (pEnd && pEnd[0] == '"')
+				unescape(m_pValue, pEnd + 1, strOut);
+			return;
+		}
+
+		char* pEnd = f->skipValue(m_pValue);
+		if (pEnd)
+			strOut.append(m_pValue, pEnd - m_pValue);
+	}
+
+private:
+	// ȡֵֵԴ벻ᱻ޸
+	bool fetchScalar(sfjson::sfJSONString& val) const
+	{
+		if (!m_pValue)
+			return false;
+
+		uint8_t ch = m_pValue[0];
+		if (ch == '"' || ch == '{' || ch == '[')
+			return false;
+		// ضϵԴֵûн
+		if (m_pFile->findScalarEnd(m_pValue) >= m_pFile->m_pMemEnd)
+			return false;
+
+		val.kType = sfjson::JVTNone;
+		return m_pFile->parseFetchString(m_pValue, val) != NULL;
+	}
+
+	// ȡһֲkeyȽϣͬʱrֵֵָĿʼλãʱNULL
+	char* fetchKey(char* pReadPos, const char* key, size_t len, sfJsonCursor& r) const
+	{
+		sfjson::JFile* f = m_pFile;
+		bool bEscaped = false, bSame;
+
+		char* pStart = pReadPos + 1;
+		char* pEnd = f->findStringEnd(pStart, bEscaped);
+		if (!pEnd || pEnd[0] != '"')
+		{
+			f->m_iErr = sfjson::JFile::kErrorName;
+			return 0;
+		}
+
+		size_t i = sfjson::findStringSpecial(pStart, pEnd - pStart);
+		if (i == (size_t)(pEnd - pStart))
+		{
+			// תֱӱȽԴ
+			bSame = i == len && memcmp(pStart, key, len) == 0;
+		}
+		else
+		{
+			std::string name;
+			if (!unescape(pReadPos, pEnd + 1, name))
+				return 0;
+			bSame = name.length() == len && memcmp(name.c_str(), key, len) == 0;
+		}
+
+		pReadPos = f->skipWhites(pEnd + 1);
+		if (!pReadPos || pReadPos >= f->m_pMemEnd || pReadPos[0] != ':')
+		{
+			f->m_iErr = sfjson::JFile::kErrorSymbol;
+			return 0;
+		}
+		pReadPos = f->skipWhites(pReadPos + 1);
+		if (!pReadPos || pReadPos >= f->m_pMemEnd)
+		{
+			f->m_iErr = sfjson::JFile::kErrorEnd;
+			return 0;
+		}
+
+		if (bSame)
+		{
+			r.m_pFile = f;
+			r.m_pValue = pReadPos;
+		}
+		return pReadPos;
+	}
+
+	// Ա֮ĶţendsʱNULLʾѾ
+	char* nextSibling(char* pReadPos, char ends) const
+	{
+		sfjson::JFile* f = m_pFile;
+		if (pReadPos)
+			pReadPos = f->skipWhites(pReadPos);
+		if (!pReadPos || pReadPos >= f->m_pMemEnd)
+			return 0;
+
+		if (pReadPos[0] == ',')
+		{
+			pReadPos = f->skipWhites(pReadPos + 1);
+			if (pReadPos && pReadPos < f->m_pMemEnd)
+				return pReadPos;
+		}
+		else if (pReadPos[0] != ends)
+		{
+			f->m_iErr = sfjson::JFile::kErrorSymbol;
+		}
+
+		return 0;
+	}
+
+	// תַȸƵstrOutĩβԭطת壬ԴͲᱻ޸
+	bool unescape(char* pStart, char* pEnd, std::string& strOut) const
+	{
+		sfjson::JFile* f = m_pFile;
+		size_t base = strOut.length(), len = pEnd - pStart;
+
+		strOut.append(pStart, len);
+
+		char* copy = &strOut[base];
+		char* pSavedEnd = f->m_pMemEnd;
+		sfjson::sfJSONString str;
+
+		f->m_pMemEnd = copy + len;
+		char* pReadPos = f->parseFetchString(copy, str);
+		f->m_pMemEnd = pSavedEnd;
+
+		if (!pReadPos)
+		{
+			strOut.resize(base);
+			return false;
+		}
+
+		memmove(copy, str.pString, str.nLength);
+		strOut.resize(base + str.nLength);
+		return true;
+	}
+
+private:
+	sfjson::JFile		*m_pFile;
+	char				*m_pValue;
+};
+
+// ĵֻԴλãroot()õڵα
+class sfJsonLazyDoc
+{
+public:
+	sfJsonLazyDoc(const char* code, size_t len)
+		: m_file(len)
+		, m_pCode(const_cast<char*>(code))
+	{
+		m_file.m_pMemEnd = m_pCode + len;
+		m_file.m_pLastPos = m_pCode;
+	}
+
+	sfJsonCursor root()
+	{
+		sfJsonCursor r;
+		char* pReadPos = m_file.skipWhites(m_pCode);
+		if (pReadPos && pReadPos < m_file.m_pMemEnd && (pReadPos[0] == '{' || pReadPos[0] == '['))
+		{
+			r.m_pFile = &m_file;
+			r.m_pValue = pReadPos;
+		}
+		else if (!m_file.m_iErr)
+		{
+			m_file.m_iErr = sfjson::JFile::kErrorSymbol;
+		}
+		return r;
+	}
+
+	inline const char* getError() { return m_file.getError(); }
+
+private:
+	sfJsonLazyDoc(const sfJsonLazyDoc&);
+	sfJsonLazyDoc& operator = (const sfJsonLazyDoc&);
+
+	sfjson::JFile		m_file;
+	char				*m_pCode;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// ֱĵʱͬһ
+#ifdef SFJ_CXX11
+typedef sfjson::KeyTable sfJsonKeys;
+#else
+typedef void sfJsonKeys;
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// ڴ
+typedef sfjson::Allocator sfJsonAllocator;
+
+// 滻ʹõڴڷκڴ֮ǰãѾڴύ·fnFreeͷţ
+static inline void sfJsonSetAllocator(const sfJsonAllocator& a)
+{
+	sfjson::allocator() = a;
+}
+
+// JsonpKeysΪNULLʱڵʹֱеΨһָ룬sfNode::findKeyָ
+static sfNode* sfJsonDecode(const char* code, size_t len, bool bCopyCode = false, uint32_t flags = 0, sfJsonKeys* pKeys = NULL)
+{
+	size_t s = sizeof(sfjson::JFile);
+	if (bCopyCode)
+		s += len;
+
+	sfjson::JFile* p = (sfjson::JFile*)sfjson::memAlloc(s);
+	new (p) sfjson::JFile(len);
+#ifdef SFJ_CXX11
+	p->setKeys(pKeys);
+#else
+	(void)pKeys;
+#endif
+
+	if (bCopyCode)
+	{
+		memcpy((char*)(p + 1), code, len);
+		if (p->parse(NULL, flags) > 0)
+			return (flags & kJsonDecodeIndex) ? p->getRoot()->buildIndex() : p->getRoot();
+	}
+	else if (p->parse(const_cast<char*>(code), flags) > 0)
+	{
+		return (flags & kJsonDecodeIndex) ? p->getRoot()->buildIndex() : p->getRoot();
+	}
+
+	p->~JFile();
+	sfjson::memFree(p);
+
+	return NULL;
+}
+static inline sfNode* sfJsonDecode(const std::string& strInput, bool bCopyCode = false, uint32_t flags = 0, sfJsonKeys* pKeys = NULL)
+{
+	return sfJsonDecode(strInput.c_str(), strInput.length(), bCopyCode, flags, pKeys);
+}
+
+// ļ롣ļӳ䵽ڴֱӽ룬Ҫļݣӳڸڵdestroyʱ
+static sfNode* sfJsonDecodeFile(const char* path, uint32_t flags = 0, sfJsonKeys* pKeys = NULL)
+{
+	sfjson::JFile* p = (sfjson::JFile*)sfjson::memAlloc(sizeof(sfjson::JFile));
+	new (p) sfjson::JFile(0);
+#ifdef SFJ_CXX11
+	p->setKeys(pKeys);
+#else
+	(void)pKeys;
+#endif
+
+	char* pMemory = p->mapFile(path);
+	if (pMemory && p->parse(pMemory, flags) > 0)
+		return (flags & kJsonDecodeIndex) ? p->getRoot()->buildIndex() : p->getRoot();
+
+	p->~JFile();
+	sfjson::memFree(p);
+
+	return NULL;
+}
+
+// ߳̽롣ڵǺܴʱֶνnThreads߳̽루Ϊ0ʱʹCPUsfJsonDecodeȫͬ
+static sfNode* sfJsonDecodeParallel(const char* code, size_t len, uint32_t nThreads = 0, bool bCopyCode = false, sfJsonKeys* pKeys = NULL)
+{
+	size_t s = sizeof(sfjson::JFile);
+	if (bCopyCode)
+		s += len;
+
+	sfjson::JFile* p = (sfjson::JFile*)sfjson::memAlloc(s);
+	new (p) sfjson::JFile(len);
+#ifdef SFJ_CXX11
+	p->setKeys(pKeys);
+#else
+	(void)pKeys;
+#endif
+
+	if (bCopyCode)
+	{
+		memcpy((char*)(p + 1), code, len);
+		if (p->parseParallel(NULL, nThreads) > 0)
+			return p->getRoot();
+	}
+	else if (p->parseParallel(const_cast<char*>(code), nThreads) > 0)
+	{
+		return p->getRoot();
+	}
+
+	p->~JFile();
+	sfjson::memFree(p);
+
+	return NULL;
+}
+static inline sfNode* sfJsonDecodeParallel(const std::string& strInput, uint32_t nThreads = 0, bool bCopyCode = false, sfJsonKeys* pKeys = NULL)
+{
+	return sfJsonDecodeParallel(strInput.c_str(), strInput.length(), nThreads, bCopyCode, pKeys);
+}
+
+// ԷʹõĽÿνǰһεĽڵءַͽṹڴ棬νԺҪڴ
+// еĽflagskJsonDecodeStructuralλ鱣JFileУkJsonDecodeIndexַУbuildIndexֻջϵڴ
+class sfJsonParser
+{
+public:
+	sfJsonParser(sfJsonKeys* pKeys = NULL)
+		: m_file(0)
+		, m_pCode(NULL)
+		, m_nCodeSize(0)
+	{
+		m_file.m_bReusable = true;
+#ifdef SFJ_CXX11
+		m_file.setKeys(pKeys);
+#else
+		(void)pKeys;
+#endif
+	}
+	~sfJsonParser()
+	{
+		if (m_pCode)
+			sfjson::memFree(m_pCode);
+	}
+
+	// 룬sfJsonDecodeͬصĸڵڱ󣬲destroyһdecodereset֮ʹ
+	sfNode* decode(const char* code, size_t len, bool bCopyCode = false, uint32_t flags = 0)
+	{
+		m_file.reset();
+
+		char* pMemory = const_cast<char*>(code);
+		if (bCopyCode)
+		{
+			// ԴĻҲֻڲʱ·
+			if (len > m_nCodeSize)
+			{
+				m_pCode = (char*)sfjson::memRealloc(m_pCode, len);
+				m_nCodeSize = len;
+			}
+			memcpy(m_pCode, code, len);
+			pMemory = m_pCode;
+		}
+
+		m_file.m_nMemSize = len;
+		if (m_file.parse(pMemory, flags) > 0)
+			return (flags & kJsonDecodeIndex) ? m_file.getRoot()->buildIndex() : m_file.getRoot();
+
+		return NULL;
+	}
+	inline sfNode* decode(const std::string& strInput, bool bCopyCode = false, uint32_t flags = 0)
+	{
+		return decode(strInput.c_str(), strInput.length(), bCopyCode, flags);
+	}
+
+	// ͷһνĽڴ汣
+	inline void reset() { m_file.reset(); }
+	inline const char* getError() { return m_file.getError(); }
+
+private:
+	sfJsonParser(const sfJsonParser&);
+	sfJsonParser& operator = (const sfJsonParser&);
+
+	sfjson::JFile		m_file;
+	char				*m_pCode;
+	size_t				m_nCodeSize;
+};
+
+#ifdef SFJ_CXX11
+//////////////////////////////////////////////////////////////////////////
+// н루NDJSON/JSON Linesÿһĵɹ̶̲߳н룬е˳򽻸صȫ
+// ÿ߳ʹԼJFileһеĽڵ㶼ЩJFileУҪΪÿһзһJFile
+class sfJsonLines
+{
+public:
+	// ÿһнĻصе˳áʧʱrootΪNULLerrΪϢrootһʼǰͷţdestroyfalseֹͣ
+	typedef bool(*fndefLineDecoded)(sfNode* root, size_t line, const char* err, void* user);
+
+	sfJsonLines(uint32_t nThreads = 0, sfJsonKeys* pKeys = NULL)
+		: m_nThreads(nThreads ? nThreads : std::thread::hardware_concurrency())
+		, m_pKeys(pKeys)
+		, m_lines(NULL)
+		, m_nLines(0)
+		, m_nLinesSize(0)
+		, m_nFirst(0)
+		, m_nCount(0)
+		, m_nRound(0)
+		, m_nPending(0)
+		, m_bQuit(false)
+		, m_pCopy(NULL)
+	{
+		if (m_nThreads < 1)
+			m_nThreads = 1;
+		else if (m_nThreads > 256)
+			m_nThreads = 256;
+
+		m_files = (sfjson::JFile**)sfjson::memAlloc(m_nThreads * sizeof(sfjson::JFile*));
+		memset(m_files, 0, m_nThreads * sizeof(sfjson::JFile*));
+
+		// 0߳̾ǵdecode̡߳߳ʧʱ쳣׳ȥѾ̻߳ʹ˵thisΪֻѾ߳̽
+		m_threads = (std::thread*)sfjson::memAlloc(m_nThreads * sizeof(std::thread));
+		for (uint32_t i = 1; i < m_nThreads; ++ i)
+		{
+#ifdef SFJ_EXCEPTIONS
+			try
+			{
+				new (m_threads + i) std::thread(&sfJsonLines::workerProc, this, i);
+			}
+			catch (...)
+			{
+				m_nThreads = i;
+				break;
+			}
+#else
+			new (m_threads + i) std::thread(&sfJsonLines::workerProc, this, i);
+#endif
+		}
+	}
+	~sfJsonLines()
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+			m_bQuit = true;
+		}
+		m_cvStart.notify_all();
+		for (uint32_t i = 1; i < m_nThreads; ++ i)
+		{
+			m_threads[i].join();
+			m_threads[i].~thread();
+		}
+		sfjson::memFree(m_threads);
+
+		releaseFiles();
+		sfjson::memFree(m_files);
+		sfjson::memFree(m_lines);
+		sfjson::memFree(m_pCopy);
+	}
+
+	// еУÿɺ˳صȻһĽڴһʹáбؽɹ
+	size_t decode(const char* code, size_t len, fndefLineDecoded fn, void* user, bool bCopyCode = false)
+	{
+		char* pReadPos = prepare(code, len, bCopyCode), *pMemEnd = pReadPos + len;
+		size_t line = 0, succeed = 0;
+		bool bContinue = true;
+
+		while (bContinue && pReadPos < pMemEnd)
+		{
+			m_nLines = 0;
+			pReadPos = splitLines(pReadPos, pMemEnd, line, (size_t)m_nThreads * SFJ_LINES_BATCH_SIZE);
+			line += m_nLines;
+
+			runRound(0, m_nLines);
+
+			for (size_t i = 0; i < m_nLines; ++ i)
+			{
+				Line& l = m_lines[i];
+				if (!l.root && !l.err)
+					continue;
+
+				if (l.root)
+					succeed ++;
+				if (!fn(l.root, l.line, l.err, user))
+				{
+					bContinue = false;
+					break;
+				}
+			}
+
+			resetFiles();
+		}
+		m_nLines = 0;
+
+		return succeed;
+	}
+	inline size_t decode(const std::string& strInput, fndefLineDecoded fn, void* user, bool bCopyCode = false)
+	{
+		return decode(strInput.c_str(), strInput.length(), fn, user, bCopyCode);
+	}
+
+	// һνеУһν򱾶Ϊֹcount/root/getErrorȡáУ
+	size_t decodeAll(const char* code, size_t len, bool bCopyCode = false)
+	{
+		char* pReadPos = prepare(code, len, bCopyCode);
+
+		m_nLines = 0;
+		splitLines(pReadPos, pReadPos + len, 0, (size_t)-1);
+		runRound(0, m_nLines);
+
+		return m_nLines;
+	}
+	inline size_t decodeAll(const std::string& strInput, bool bCopyCode = false)
+	{
+		return decodeAll(strInput.c_str(), strInput.length(), bCopyCode);
+	}
+
+	inline size_t count() const { return m_nLines; }
+	// iеĸڵ㣬л߽ʧʱΪNULL
+	inline sfNode* root(size_t i) const { return i < m_nLines ? m_lines[i].root : NULL; }
+	// iеĴϢûдʱΪNULL
+	inline const char* getError(size_t i) const { return i < m_nLines ? m_lines[i].err : NULL; }
+
+private:
+	sfJsonLines(const sfJsonLines&);
+	sfJsonLines& operator = (const sfJsonLines&);
+
+	struct Line
+	{
+		char			*pStart, *pEnd;
+		size_t			line;
+		sfNode			*root;
+		const char		*err;
+	};
+
+	char* prepare(const char* code, size_t len, bool bCopyCode)
+	{
+		resetFiles();
+		m_nLines = 0;
+
+		if (!bCopyCode)
+			return const_cast<char*>(code);
+
+		m_pCopy = (char*)sfjson::memRealloc(m_pCopy, len + 1);
+		memcpy(m_pCopy, code, len);
+		return m_pCopy;
+	}
+
+	// pReadPosʼзУֱгֽﵽnBatchSizeΪֹһĿʼλ
+	char* splitLines(char* pReadPos, char* pMemEnd, size_t line, size_t nBatchSize)
+	{
+		char* pStart = pReadPos;
+		while (pReadPos < pMemEnd && (size_t)(pReadPos - pStart) < nBatchSize)
+		{
+			if (m_nLines == m_nLinesSize)
+			{
+				m_nLinesSize = m_nLinesSize ? m_nLinesSize * 2 : 1024;
+				m_lines = (Line*)sfjson::memRealloc(m_lines, m_nLinesSize * sizeof(Line));
+			}
+
+			Line& l = m_lines[m_nLines ++];
+			l.pStart = pReadPos;
+			l.pEnd = pReadPos + sfjson::findLineEnd(pReadPos, pMemEnd - pReadPos);
+			l.line = line ++;
+			l.root = NULL;
+			l.err = NULL;
+
+			pReadPos = l.pEnd + 1;
+		}
+
+		return pReadPos;
+	}
+
+	// [first, first + count)֮ƽ̴ָ̣߳߳һΣȴ߳
+	void runRound(size_t first, size_t count)
+	{
+		m_nFirst = first;
+		m_nCount = count;
+
+		if (m_nThreads > 1)
+		{
+			{
+				std::lock_guard<std::mutex> guard(m_lock);
+				m_nPending = m_nThreads - 1;
+				m_nRound ++;
+			}
+			m_cvStart.notify_all();
+		}
+
+		parseSlice(0);
+
+		if (m_nThreads > 1)
+		{
+			std::unique_lock<std::mutex> guard(m_lock);
+			while (m_nPending)
+				m_cvDone.wait(guard);
+		}
+	}
+
+	void workerProc(uint32_t idx)
+	{
+		uint32_t nRound = 0;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> guard(m_lock);
+				while (!m_bQuit && m_nRound == nRound)
+					m_cvStart.wait(guard);
+				if (m_bQuit)
+					return;
+				nRound = m_nRound;
+			}
+
+			parseSlice(idx);
+
+			std::lock_guard<std::mutex> guard(m_lock);
+			if (-- m_nPending == 0)
+				m_cvDone.notify_one();
+		}
+	}
+
+	void parseSlice(uint32_t idx)
+	{
+		size_t i = m_nFirst + m_nCount * idx / m_nThreads, end = m_nFirst + m_nCount * (idx + 1) / m_nThreads;
+		if (i == end)
+			return;
+
+		sfjson::JFile* f = m_files[idx];
+		if (!f)
+		{
+			f = m_files[idx] = (sfjson::JFile*)sfjson::memAlloc(sizeof(sfjson::JFile));
+			new (f) sfjson::JFile(0);
+			f->setKeys(m_pKeys);
+		}
+
+		for ( ; i < end; ++ i)
+		{
+			Line& l = m_lines[i];
+
+			// вĵ
+			if (sfjson::findNonWhite(l.pStart, l.pEnd - l.pStart) == (size_t)(l.pEnd - l.pStart))
+				continue;
+
+			l.root = (sfNode*)f->parseLine(l.pStart, l.pEnd);
+			if (!l.root)
+				l.err = f->getError();
+		}
+	}
+
+	// ߳JFileеĽڴһʹ
+	void resetFiles()
+	{
+		for (uint32_t i = 0; i < m_nThreads; ++ i)
+		{
+			if (m_files[i])
+				m_files[i]->reset();
+		}
+	}
+
+	void releaseFiles()
+	{
+		for (uint32_t i = 0; i < m_nThreads; ++ i)
+		{
+			if (m_files[i])
+			{
+				m_files[i]->~JFile();
+				sfjson::memFree(m_files[i]);
+				m_files[i] = NULL;
+			}
+		}
+	}
+
+private:
+	uint32_t				m_nThreads;
+	sfJsonKeys				*m_pKeys;
+	sfjson::JFile			**m_files;
+	std::thread				*m_threads;
+
+	Line					*m_lines;
+	size_t					m_nLines, m_nLinesSize;
+	size_t					m_nFirst, m_nCount;
+
+	std::mutex				m_lock;
+	std::condition_variable	m_cvStart, m_cvDone;
+	uint32_t				m_nRound, m_nPending;
+	bool					m_bQuit;
+
+	char					*m_pCopy;
+};
+#endif
+
+// ֱʹþַ̬ͬʱٷڴҲٸJsonַ
+#define sfJsonDecl(varname) char varname[sizeof(sfjson::JFile)]
+
+static inline sfNode* sfJsonDecodeFixed(void* jFileMem, const char* code, size_t len)
+{
+	sfjson::JFile* p = (sfjson::JFile*)jFileMem;
+	new (p) sfjson::JFile(len);
+	p->setExternal();
+
+	if (p->parse(const_cast<char*>(code)) > 0)
+		return p->getRoot();
+
+	return NULL;
+}
+static sfNode* sfJsonDecodeFixed(void* jFileMem, const std::string& strInput)
+{
+	return sfJsonDecodeFixed(jFileMem, strInput.c_str(), strInput.length());
+}
+
+// ڵṩarenaջϵ顢ڴеһȣн룬JFileõջڵ͸ƵԴ루bCopyCodeΪtrueʱarena
+/*
+ * arenaҪsizeof(sfjson::JFile)ֽڣԼ2KBÿڵռsizeof(sfNodeBase)ֽ
+ * arenaʱbHeapFallbackΪtrueӶϼ䣬ʧ
+ * ɹʱroot->destroy()ͷţֻͷŴӶϷڴ棬arenaɵ߹ʧʱNULLppErrΪNULLʱشϢ
+ *   char arena[16384];
+ *   sfNode* root = sfJsonDecodeArena(arena, sizeof(arena), msg, msgLen);
+ */
+static sfNode* sfJsonDecodeArena(void* arena, size_t arenaSize, const char* code, size_t len, bool bCopyCode = false, bool bHeapFallback = false, const char** ppErr = NULL)
+{
+	if (arenaSize < sizeof(sfjson::JFile))
+	{
+		if (ppErr)
+			*ppErr = "arena exhausted";
+		return NULL;
+	}
+
+	sfjson::JFile* p = (sfjson::JFile*)arena;
+	new (p) sfjson::JFile(len);
+	p->setExternal();
+
+	if (p->parseArena((char*)(p + 1), arenaSize - sizeof(sfjson::JFile), code, bCopyCode, bHeapFallback) > 0)
+		return p->getRoot();
+
+	if (ppErr)
+		*ppErr = p->getError();
+	p->~JFile();
+
+	return NULL;
+}
+
+// SAXʽ룺ڵа˳صhandlerڴռúĵС޹
+/*
+ * handlerֻͣҪЩȫãû麯һfalseʱֹ
+ *   struct MyHandler {
+ *       bool onStartObject();
+ *       bool onKey(const char* str, size_t len);
+ *       bool onEndObject(size_t memberCount);
+ *       bool onStartArray();
+ *       bool onEndArray(size_t elementCount);
+ *       bool onString(const char* str, size_t len);
+ *       bool onInt64(int64_t val);
+ *       bool onDouble(double val);
+ *       bool onBool(bool val);
+ *       bool onNull();
+ *   };
+ * sfJsonDecodeһcodeԭؽģַᱻԭطת岢0βstrֱָcodeеڴ
+ */
+template <typename H> static bool sfJsonParse(const char* code, size_t len, H& handler)
+{
+	sfjson::JFile f(len);
+	return f.parseSax(const_cast<char*>(code), handler) > 0;
+}
+
+// 룺ݷֳɶεʱʹãҪȰƴ
+/*
+ *   sfjson::JFile* p = sfJsonDecodeBegin();
+ *   while (յ)
+ *       if (!p->feed(chunk, chunkLength)) ;
+ *   sfNode* root = p->finish();
+ *   ɹʱroot->destroy()ͷţʧʱp->getError()ȡôϢȻsfJsonDecodeCancel(p)ͷ
+ */
+static sfjson::JFile* sfJsonDecodeBegin()
+{
+	sfjson::JFile* p = (sfjson::JFile*)sfjson::memAlloc(sizeof(sfjson::JFile));
+	new (p) sfjson::JFile((size_t)0);
+
+	return p;
+}
+static inline void sfJsonDecodeCancel(sfjson::JFile* p)
+{
+	p->~JFile();
+	sfjson::memFree(p);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Ŵtapeʽĵ
+/*
+ * еֵ˳һuint64_tУʱҪڽڵ֮תڴҲֻнڵļ֮һ
+ * ÿֵĸ8λͱǣ56λݣ
+ *   '{' '['		Ŀʼ32λǶӦĽֵλã24λӽڵ0xFFFFFFʱΪ0xFFFFFF
+ *   '}' ']'		ĽǶӦĿʼֵλ
+ *   '"'			ַеҲǣַеƫƣδ4ֽڳȡַݺͽβ0
+ *   'l' 'd'		Сֵһ
+ *   't' 'f' 'n'	truefalsenull
+ * ֵֺ
+ *
+ *   sfJsonTape tape;
+ *   if (tape.decode(jsonString, stringLength))
+ *       puts(tape.root().find("name").toString().c_str());
+ */
+class sfTapeNode
+{
+	friend class sfJsonTape;
+public:
+	inline sfTapeNode() : m_pTape(NULL), m_pStrings(NULL), m_nPos(0), m_nKey(0) {}
+
+	inline bool isValid() const { return m_pTape != NULL; }
+
+	// ֵͣsfNodeValueType
+	inline uint32_t type() const { return m_pTape ? typeAt(m_nPos) : (uint32_t)JATNullValue; }
+
+	// ڶе֣ڶʱNULL
+	inline const char* name(size_t* len = NULL) const
+	{
+		if (!m_pTape || !m_nKey)
+			return NULL;
+		return string(m_nKey, len);
+	}
+
+	// ӽڵ
+	uint32_t childCount() const
+	{
+		if (!m_pTape || (tag(m_nPos) != '{' && tag(m_nPos) != '['))
+			return 0;
 
-		//ȡLuaַ
-		char* parseFetchLuaString(char* pReadPos, uint32_t eqSyms, sfJSONString& str)
+		uint32_t cc = (uint32_t)(m_pTape[m_nPos] >> 32) & 0xFFFFFF;
+		if (cc == 0xFFFFFF)
 		{
-			m_pLastPos = pReadPos;
+			cc = 0;
+			for (sfTapeNode n = child(); n.isValid(); n = n.next())
+				cc ++;
+		}
+		return cc;
+	}
 
-			char* src = pReadPos;
-			size_t i, k, ik, iend = m_pMemEnd - pReadPos - 2;
-			for (i = 0; i < iend; ++ i)
-			{
-				if (src[i] == ']')
-				{
-					for (k = 1; k < eqSyms; ++ k)
-					{
-						if (src[i + k] != '=')
-							break;
-					}
+	// һӽڵһֵܽڵ㣬ûʱЧڵ
+	sfTapeNode child() const
+	{
+		if (!isContainer())
+			return sfTapeNode();
+		return atValue(childAt(m_nPos), tag(m_nPos) == '{');
+	}
+	inline sfTapeNode next() const
+	{
+		if (!m_pTape)
+			return sfTapeNode();
+		return atValue(nextAt(m_nPos, m_nKey != 0), m_nKey != 0);
+	}
 
-					ik = i + k;
-					if (ik < iend && k - 1 == eqSyms && src[ik] == ']')
-					{
-						str.pString = src;
-						str.nLength = i;
-						return src + ik;
-					}
-				}
-			}
+	// ֲңͬӽڵʱصһlenΪ0ʱʹstrlenֳ
+	sfTapeNode find(const char* key, size_t len = 0) const
+	{
+		if (!m_pTape || tag(m_nPos) != '{')
+			return sfTapeNode();
+		return atValue(sfjson::findMember(Nodes(*this), m_nPos, key, len ? len : strlen(key)), true);
+	}
 
-			m_iErr = kErrorEnd;
+	// ȡ0ʼ
+	sfTapeNode index(uint32_t index) const
+	{
+		if (!isContainer())
+			return sfTapeNode();
+		return atValue(sfjson::indexMember(Nodes(*this), m_nPos, index), tag(m_nPos) == '{');
+	}
+	inline sfTapeNode operator [] (uint32_t i) const { return index(i); }
+
+	// Сתͣͷ0
+	double toDouble() const
+	{
+		if (!m_pTape)
 			return 0;
-		}
 
-	private:
-		static inline uint32_t readUnicode(const char* p)
+		switch (tag(m_nPos))
 		{
-			uint32_t code = 0;
-			for (uint32_t i = 0, shift = 12; i < 4; ++ i, shift -= 4)
-			{
-				uint8_t ch = p[i];
-				switch (json_value_char_tbl[ch])
-				{
-				case 1: code |= (ch - '0') << shift; break;
-				case 4: code |= (ch - 'a' + 10) << shift; break;
-				case 6: code |= (ch - 'A' + 10) << shift; break;
-				}
-			}
-
-			return code;
+		case 'd': return word2double(m_pTape[m_nPos + 1]);
+		case 'l': return (double)(int64_t)m_pTape[m_nPos + 1];
+		case 't': return 1;
 		}
+		return 0;
+	}
+	// Сתͣͷ0
+	int64_t toInteger() const
+	{
+		if (!m_pTape)
+			return 0;
 
-		static inline uint32_t unicode2utf8(uint32_t wchar)
+		switch (tag(m_nPos))
 		{
-			if (wchar < 0xC0)
-				return 1;
-			if (wchar < 0x800)
-				return 2;
-			if (wchar < 0x10000)
-				return 3;
-			if (wchar < 0x200000)
-				return 4;
-
-			return 1;
+		case 'd': return (int64_t)word2double(m_pTape[m_nPos + 1]);
+		case 'l': return (int64_t)m_pTape[m_nPos + 1];
+		case 't': return 1;
 		}
+		return 0;
+	}
+	// תַ鲻
+	inline void toString(std::string& strOut) const
+	{
+		if (m_pTape)
+			sfjson::valueToString(Nodes(*this), m_nPos, strOut);
+	}
+	inline std::string toString() const
+	{
+		std::string r;
+		toString(r);
+		return r;
+	}
 
-		static char* unicode2utf8(uint32_t _wchar, char *_utf8)
-		{
-			char *utf8 = _utf8;
-			uint32_t wchar = _wchar, len = 0;
+	// ʽΪַ׷ӵstrOutĩβsfNode::printToȫͬsfNode::printToһֱдַ
+	bool printTo(std::string& strOut, uint32_t flags = kJsonUnicodes) const
+	{
+		if (!isContainer())
+			return false;
 
-			if (wchar < 0xC0)
-			{
-				utf8[0] = (char)wchar;
-				len = 1;
-			}
-			else if (wchar < 0x800)
-			{
-				utf8[0] = 0xc0 | (wchar >> 6);
-				utf8[1] = 0x80 | (wchar & 0x3f);
-				len = 2;
-			}
-			else if (wchar < 0x10000)
-			{
-				utf8[0] = 0xe0 | (wchar >> 12);
-				utf8[1] = 0x80 | ((wchar >> 6) & 0x3f);
-				utf8[2] = 0x80 | (wchar & 0x3f);
-				len = 3;
-			}
-			else if (wchar < 0x200000)
-			{
-				utf8[0] = 0xf0 | ((int)wchar >> 18);
-				utf8[1] = 0x80 | ((wchar >> 12) & 0x3f);
-				utf8[2] = 0x80 | ((wchar >> 6) & 0x3f);
-				utf8[3] = 0x80 | (wchar & 0x3f);
-				len = 4;
-			}
+		sfjson::StringBuffer buf(strOut, SFJ_ENCODE_INIT_MEMSIZE);
+		printWhole(buf, flags);
+		buf.finish();
+		return true;
+	}
+	// 뵽ֶεĻУȻݶνص
+	bool printTo(sfNode::fndefNodePrinted fn, void* user, uint32_t flags = kJsonUnicodes) const
+	{
+		if (!isContainer())
+			return false;
 
-			return utf8 + len;
-		}
+		char fixbuf[SFJ_ENCODE_INIT_MEMSIZE];
+		sfjson::MemList encodeBuf;
+		encodeBuf.wrapNode(fixbuf, sizeof(fixbuf));
+		printWhole(encodeBuf, flags);
+
+		if (fn)
+			sfjson::printMemList(encodeBuf, fn, user);
+		return true;
+	}
+
+private:
+	const uint64_t		*m_pTape;
+	const char			*m_pStrings;
+	uint32_t			m_nPos;		// ֵڵλ
+	uint32_t			m_nKey;		// ڶʱڵλãΪ00Ǹڵ㣬֣
+
+	// sfjson::printMembersͨúķʲԣڵֵڴŴеλñʾֵǰһ
+	class Nodes
+	{
+	public:
+		typedef uint32_t Ref;
+		const sfTapeNode	&tape;
+
+		inline Nodes(const sfTapeNode& t) : tape(t) {}
+
+		inline uint32_t type(Ref pos) const { return tape.typeAt(pos); }
+		inline Ref child(Ref pos) const { return tape.childAt(pos); }
+		inline Ref next(Ref pos, bool bInObject) const { return tape.nextAt(pos, bInObject); }
+		inline const char* name(Ref pos, size_t& len) const { return tape.string(pos - 1, &len); }
+		inline const char* string(Ref pos, size_t& len) const { return tape.string(pos, &len); }
+		inline bool boolean(Ref pos) const { return tape.tag(pos) == 't'; }
+		inline int64_t integer(Ref pos) const { return (int64_t)tape.m_pTape[pos + 1]; }
+		inline double number(Ref pos) const { return word2double(tape.m_pTape[pos + 1]); }
 	};
-}
 
-//////////////////////////////////////////////////////////////////////////
-class sfNode : public sfNodeBase
+	inline sfTapeNode at(uint32_t pos, uint32_t key) const
+	{
+		sfTapeNode n;
+		n.m_pTape = m_pTape;
+		n.m_pStrings = m_pStrings;
+		n.m_nPos = pos;
+		n.m_nKey = key;
+		return n;
+	}
+	// posΪ0ʱЧڵ㣬bInObjectΪtrueʱֵǰһ
+	inline sfTapeNode atValue(uint32_t pos, bool bInObject) const
+	{
+		if (!pos)
+			return sfTapeNode();
+		return at(pos, bInObject ? pos - 1 : 0);
+	}
+	inline bool isContainer() const
+	{
+		return m_pTape && (tag(m_nPos) == '{' || tag(m_nPos) == '[');
+	}
+	// 뱾ڵ㣨飩β
+	template <typename Buf> void printWhole(Buf& buf, uint32_t flags) const
+	{
+		buf.addChar(tag(m_nPos));
+		sfjson::printMembers(buf, Nodes(*this), m_nPos, flags);
+		buf.addChar(tag(m_nPos) + 2);
+	}
+	inline uint8_t tag(uint32_t pos) const
+	{
+		return (uint8_t)(m_pTape[pos] >> 56);
+	}
+	uint32_t typeAt(uint32_t pos) const
+	{
+		switch (tag(pos))
+		{
+		case '{': return JATObject;
+		case '[': return JATArray;
+		case '"': return JATString;
+		case 'l': return JATIntValue;
+		case 'd': return JATDoubleValue;
+		case 't': case 'f': return JATBooleanValue;
+		}
+		return JATNullValue;
+	}
+	// ĵһֵλãյʱ򷵻0
+	inline uint32_t childAt(uint32_t pos) const
+	{
+		uint8_t t = tag(pos);
+		if (tag(pos + 1) == t + 2)
+			return 0;
+		return t == '{' ? pos + 2 : pos + 1;
+	}
+	// һֵֵλãûʱ0
+	inline uint32_t nextAt(uint32_t pos, bool bInObject) const
+	{
+		pos = after(pos);
+		uint8_t t = tag(pos);
+		if (t == '}' || t == ']')
+			return 0;
+		return bInObject ? pos + 1 : pos;
+	}
+	// ֵ֮λ
+	inline uint32_t after(uint32_t pos) const
+	{
+		switch (tag(pos))
+		{
+		case '{': case '[': return (uint32_t)m_pTape[pos] + 1;
+		case 'l': case 'd': return pos + 2;
+		}
+		return pos + 1;
+	}
+	inline const char* string(uint32_t pos, size_t* len) const
+	{
+		const char* p = m_pStrings + (m_pTape[pos] & 0x00FFFFFFFFFFFFFFULL);
+		if (len)
+		{
+			uint32_t l;
+			memcpy(&l, p, 4);
+			*len = l;
+		}
+		return p + 4;
+	}
+	static inline double word2double(uint64_t w)
+	{
+		double d;
+		memcpy(&d, &w, sizeof(d));
+		return d;
+	}
+};
+
+class sfJsonTape
 {
 public:
-	typedef void(*fndefNodePrinted)(const char* code, size_t len, void* user);
-	static void fnNodePrintToString(const char* code, size_t len, void* user)
+	inline sfJsonTape()
+		: m_pTape(NULL), m_nTape(0), m_nTapeSize(0)
+		, m_pStrings(NULL), m_nStrings(0), m_nStringsSize(0)
+		, m_pError(NULL)
+	{}
+	~sfJsonTape()
 	{
-		std::string* str = (std::string*)user;
-		if (code)
-			str->append(code, len);
-		else
-			str->reserve(len);
+		if (m_pTape)
+			sfjson::memFree(m_pTape);
+		if (m_pStrings)
+			sfjson::memFree(m_pStrings);
 	}
 
-public:
-	// ˳
-	inline sfNode* find(const char* str) const
+	// 룬֮ǰݻᱻsfJsonDecodeһĬcodeԭؽ루޸codebCopyCodeΪtrueʱȸһ
+	bool decode(const char* code, size_t len, bool bCopyCode = false)
 	{
-		sfNode* n = child;
-		while (n)
+		m_nTape = m_nStrings = 0;
+		m_pError = NULL;
+
+		// Դ볤ȹʼСʱٰ2
+		if (!reserveTape(len / 8 + 16) || !reserveStrings(len / 2 + 64))
+			return false;
+
+		char* pCode = const_cast<char*>(code);
+		if (bCopyCode)
 		{
-			if (strcmp(n->nameKey, str) == 0)
-				return n;
-			n = n->next;
+			pCode = (char*)sfjson::memAlloc(len + 1);
+			memcpy(pCode, code, len);
+			pCode[len] = 0;
 		}
-		return NULL;
+
+		sfjson::JFile f(len);
+		Builder builder(this);
+		bool r = f.parseSax(pCode, builder) > 0;
+
+		if (bCopyCode)
+			sfjson::memFree(pCode);
+
+		if (!r)
+		{
+			m_nTape = 0;
+			m_pError = builder.m_bNoMemory ? "out of memory" : f.getError();
+		}
+		return r;
 	}
-	// ȡ0ʼ
-	inline sfNode* index(uint32_t index) const
+	inline bool decode(const std::string& strInput)
 	{
-		uint32_t i = 0;
-		sfNode* n = child;
-		while (i < index && n)
-			n = n->next;
-		return n;
+		return decode(strInput.c_str(), strInput.length(), true);
 	}
-	// ȡ0ʼ
-	inline sfNode* operator [] (uint32_t index) const
+
+	sfTapeNode root() const
 	{
-		uint32_t i = 0;
-		sfNode* n = child;
-		while (i < index && n)
-			n = n->next;
+		sfTapeNode n;
+		if (m_nTape)
+		{
+			n.m_pTape = m_pTape;
+			n.m_pStrings = m_pStrings;
+		}
 		return n;
 	}
 
-	// һսڵ
-	sfNode* createObject(const char* name = NULL, size_t len = 0)
+	inline const char* getError() const { return m_pError; }
+	// ռõڴֽŴַ壩
+	inline size_t memoryUsed() const { return m_nTape * sizeof(uint64_t) + m_nStrings; }
+
+private:
+	sfJsonTape(const sfJsonTape&);
+	sfJsonTape& operator = (const sfJsonTape&);
+
+	uint64_t		*m_pTape;
+	size_t			m_nTape, m_nTapeSize;
+	char			*m_pStrings;
+	size_t			m_nStrings, m_nStringsSize;
+	const char		*m_pError;
+
+	bool reserveTape(size_t cc)
 	{
-		sfjson::JFile* p = (sfjson::JFile*)pFile;
+		if (m_nTape + cc <= m_nTapeSize)
+			return true;
+
+		size_t newSize = std::max(m_nTapeSize * 2, m_nTape + cc);
+		uint64_t* p = (uint64_t*)sfjson::memRealloc(m_pTape, newSize * sizeof(uint64_t));
+		if (!p)
+			return false;
+
+		m_pTape = p;
+		m_nTapeSize = newSize;
+		return true;
+	}
+	bool reserveStrings(size_t len)
+	{
+		if (m_nStrings + len <= m_nStringsSize)
+			return true;
+
+		size_t newSize = std::max(m_nStringsSize * 2, m_nStrings + len);
+		char* p = (char*)sfjson::memRealloc(m_pStrings, newSize);
+		if (!p)
+			return false;
+
+		m_pStrings = p;
+		m_nStringsSize = newSize;
+		return true;
+	}
+
+	// SAXʽʱдŴhandler
+	class Builder
+	{
+	public:
+		bool			m_bNoMemory;
+
+		inline Builder(sfJsonTape* pTape) : m_bNoMemory(false), m_pTape(pTape), m_nOpens(0) {}
+
+		inline bool onStartObject() { return startNode('{'); }
+		inline bool onEndObject(size_t cc) { return endNode('}', cc); }
+		inline bool onStartArray() { return startNode('['); }
+		inline bool onEndArray(size_t cc) { return endNode(']', cc); }
+
+		inline bool onKey(const char* str, size_t len) { return addString(str, len); }
+		inline bool onString(const char* str, size_t len) { return addString(str, len); }
+		inline bool onInt64(int64_t val) { return add2('l', (uint64_t)val); }
+		inline bool onDouble(double val)
+		{
+			uint64_t w;
+			memcpy(&w, &val, sizeof(w));
+			return add2('d', w);
+		}
+		inline bool onBool(bool val) { return add(val ? 't' : 'f', 0); }
+		inline bool onNull() { return add('n', 0); }
+
+	private:
+		sfJsonTape		*m_pTape;
+		uint32_t		m_nOpens;
+		uint32_t		m_opens[SFJ_MAX_PARSE_LEVEL];
+
+		inline bool add(uint8_t t, uint64_t payload)
+		{
+			sfJsonTape* p = m_pTape;
+			if (!p->reserveTape(1))
+				return noMemory();
+
+			p->m_pTape[p->m_nTape ++] = ((uint64_t)t << 56) | payload;
+			return true;
+		}
+		inline bool add2(uint8_t t, uint64_t val)
+		{
+			sfJsonTape* p = m_pTape;
+			if (!p->reserveTape(2))
+				return noMemory();
+
+			p->m_pTape[p->m_nTape ++] = (uint64_t)t << 56;
+			p->m_pTape[p->m_nTape ++] = val;
+			return true;
+		}
+		inline bool addString(const char* str, size_t len)
+		{
+			sfJsonTape* p = m_pTape;
+			if (!p->reserveStrings(len + 5))
+				return noMemory();
+
+			size_t offset = p->m_nStrings;
+			uint32_t l = (uint32_t)len;
+			char* dst = p->m_pStrings + offset;
+
+			memcpy(dst, &l, 4);
+			memcpy(dst + 4, str, len);
+			dst[len + 4] = 0;
+			p->m_nStrings += len + 5;
+
+			return add('"', offset);
+		}
+		inline bool startNode(uint8_t t)
+		{
+			m_opens[m_nOpens ++] = (uint32_t)m_pTape->m_nTape;
+			return add(t, 0);
+		}
+		inline bool endNode(uint8_t t, size_t cc)
+		{
+			sfJsonTape* p = m_pTape;
+			uint32_t start = m_opens[-- m_nOpens];
+			uint64_t end = p->m_nTape;
+
+			if (cc > 0xFFFFFF)
+				cc = 0xFFFFFF;
+			p->m_pTape[start] |= ((uint64_t)cc << 32) | end;
+			return add(t, start);
+		}
+		inline bool noMemory()
+		{
+			m_bNoMemory = true;
+			return false;
+		}
+	};
+};
+
+//////////////////////////////////////////////////////////////////////////
+// ոʽĽڵ
+/*
+ * ڵһУ֮32λ±ָ룬ֵַַֺУҲ32λƫƱʾÿڵֻ24ֽ
+ * childLastpFileӽڵɽʱã˽ֻ
+ * ±0Ǹڵ㣬ַƫ0ǿַnextchildnameΪ0ʱʾû
+ *
+ *   sfJsonCompact doc;
+ *   if (doc.decode(jsonString, stringLength))
+ *       puts(doc.root().find("name").toString().c_str());
+ */
+class sfCompactNodeBase
+{
+public:
+	uint32_t		next;			// һֵܽڵ±
+	uint32_t		name;			// ַеƫƣδ4ֽڳȡֺͽβ0
+	uint32_t		nodeType;
+	uint32_t		count;			// 飺ӽڵַַ
+	union {
+		bool		bval;
+		int64_t		ival;
+		double		dval;
+		uint32_t	str;			// ַַеƫƣ0β
+		uint32_t	child;			// һӽڵ±
+	};
+};
 
-		sfNode* n = (sfNode*)p->m_nodesPool.allocate();
-		memset(n, 0, sizeof(sfNode));
+// ڵĴС24ֽ
+typedef char sfCompactNodeSizeCheck[sizeof(sfCompactNodeBase) == 24 ? 1 : -1];
 
-		n->nodeType = JATObject;
-		n->pFile = pFile;
+class sfCompactNode
+{
+	friend class sfJsonCompact;
+public:
+	inline sfCompactNode() : m_pNodes(NULL), m_pStrings(NULL), m_nIndex(0) {}
 
-		if (name)
-			n->name(name, len);
+	inline bool isValid() const { return m_pNodes != NULL; }
 
-		return n;
-	}
-	// һ
-	sfNode* createArray()
-	{
-		sfjson::JFile* p = (sfjson::JFile*)pFile;
+	// ֵͣsfNodeValueType
+	inline uint32_t type() const { return m_pNodes ? node().nodeType : (uint32_t)JATNullValue; }
 
-		sfNode* n = (sfNode*)p->m_nodesPool.allocate();
-		memset(n, 0, sizeof(sfNode));
+	// ڶе֣ڶʱNULL
+	const char* name(size_t* len = NULL) const
+	{
+		if (!m_pNodes || !node().name)
+			return NULL;
+
+		size_t l;
+		const char* p = Nodes(*this).name(m_nIndex, l);
+		if (len)
+			*len = l;
+		return p;
+	}
 
-		n->nodeType = JATArray;
-		n->pFile = pFile;
+	// ӽڵ
+	inline uint32_t childCount() const
+	{
+		return m_pNodes && node().nodeType >= JATObject ? node().count : 0;
+	}
 
-		return n;
+	// һӽڵһֵܽڵ㣬ûʱЧڵ
+	inline sfCompactNode child() const
+	{
+		if (!m_pNodes || node().nodeType < JATObject || !node().count)
+			return sfCompactNode();
+		return at(node().child);
 	}
-	// һֵ
-	sfNode* createValue()
+	inline sfCompactNode next() const
 	{
-		sfjson::JFile* p = (sfjson::JFile*)pFile;
+		if (!m_pNodes || !node().next)
+			return sfCompactNode();
+		return at(node().next);
+	}
 
-		sfNode* n = (sfNode*)p->m_nodesPool.allocate();
-		memset(n, 0, sizeof(sfNode));
+	// ֲңͬӽڵʱصһlenΪ0ʱʹstrlenֳ
+	sfCompactNode find(const char* key, size_t len = 0) const
+	{
+		if (!m_pNodes || node().nodeType != JATObject)
+			return sfCompactNode();
 
-		n->pFile = pFile;
+		uint32_t i = sfjson::findMember(Nodes(*this), m_nIndex, key, len ? len : strlen(key));
+		return i ? at(i) : sfCompactNode();
+	}
 
-		return n;
+	// ȡ0ʼ
+	sfCompactNode index(uint32_t index) const
+	{
+		if (index >= childCount())
+			return sfCompactNode();
+		return at(sfjson::indexMember(Nodes(*this), m_nIndex, index));
 	}
+	inline sfCompactNode operator [] (uint32_t i) const { return index(i); }
 
-	// Ϊڵ㴴һڵ㣬ڵӽȥ
-	sfNode* createParentObject(const char* name, size_t len = 0)
+	// Сתͣͷ0
+	inline double toDouble() const
 	{
-		sfjson::JFile* p = (sfjson::JFile*)pFile;
+		if (!m_pNodes)
+			return 0;
 
-		sfNode* n = (sfNode*)p->m_nodesPool.allocate();
-		memset(n, 0, sizeof(sfNode));
+		const sfCompactNodeBase& n = node();
+		if (n.nodeType == JATDoubleValue)
+			return n.dval;
+		if (n.nodeType == JATIntValue)
+			return (double)n.ival;
+		if (n.nodeType == JATBooleanValue)
+			return n.bval;
+		return 0;
+	}
+	// Сתͣͷ0
+	inline int64_t toInteger() const
+	{
+		if (!m_pNodes)
+			return 0;
 
-		n->nodeType = JATObject;
-		n->pFile = pFile;
-		n->add(this);
+		const sfCompactNodeBase& n = node();
+		if (n.nodeType == JATIntValue)
+			return n.ival;
+		if (n.nodeType == JATDoubleValue)
+			return (int64_t)n.dval;
+		if (n.nodeType == JATBooleanValue)
+			return n.bval;
+		return 0;
+	}
+	// תַ鲻
+	inline void toString(std::string& strOut) const
+	{
+		if (m_pNodes)
+			sfjson::valueToString(Nodes(*this), m_nIndex, strOut);
+	}
+	inline std::string toString() const
+	{
+		std::string r;
+		toString(r);
+		return r;
+	}
 
-		if (name)
-			this->name(name, len);
+	// ʽΪַ׷ӵstrOutĩβsfNode::printToȫͬsfNode::printToһֱдַ
+	bool printTo(std::string& strOut, uint32_t flags = kJsonUnicodes) const
+	{
+		if (!m_pNodes || node().nodeType < JATObject)
+			return false;
 
-		return n;
+		sfjson::StringBuffer buf(strOut, SFJ_ENCODE_INIT_MEMSIZE);
+		printWhole(buf, flags);
+		buf.finish();
+		return true;
 	}
-	// һ
-	sfNode* createParentArray()
+	// 뵽ֶεĻУȻݶνص
+	bool printTo(sfNode::fndefNodePrinted fn, void* user, uint32_t flags = kJsonUnicodes) const
 	{
-		sfjson::JFile* p = (sfjson::JFile*)pFile;
-
-		sfNode* n = (sfNode*)p->m_nodesPool.allocate();
-		memset(n, 0, sizeof(sfNode));
+		if (!m_pNodes || node().nodeType < JATObject)
+			return false;
 
-		n->nodeType = JATArray;
-		n->pFile = pFile;
-		n->add(this);
+		char fixbuf[SFJ_ENCODE_INIT_MEMSIZE];
+		sfjson::MemList encodeBuf;
+		encodeBuf.wrapNode(fixbuf, sizeof(fixbuf));
+		printWhole(encodeBuf, flags);
 
-		return n;
+		if (fn)
+			sfjson::printMemList(encodeBuf, fn, user);
+		return true;
 	}
 
-	// һѾõĽڵӵڵ³Ϊӽڵ㲢this
-	sfNode* add(sfNode* n)
-	{
-		childCount ++;
-		if (child)
-			childLast->next = n;
-		else
-			child = n;
-		childLast = n;
+private:
+	const sfCompactNodeBase		*m_pNodes;
+	const char					*m_pStrings;
+	uint32_t					m_nIndex;
 
-		return this;
+	inline const sfCompactNodeBase& node() const { return m_pNodes[m_nIndex]; }
+	// 뱾ڵ㣨飩β
+	template <typename Buf> void printWhole(Buf& buf, uint32_t flags) const
+	{
+		buf.addChar(node().nodeType == JATObject ? '{' : '[');
+		sfjson::printMembers(buf, Nodes(*this), m_nIndex, flags);
+		buf.addChar(node().nodeType == JATObject ? '}' : ']');
 	}
-	// һѾõĽڵӵڵ³Ϊӽڵ㲢ֺ󷵻this
-	sfNode* add(sfNode* n, const char* name, size_t len = 0)
+	inline sfCompactNode at(uint32_t index) const
 	{
-		n->name(name, len);
-
-		childCount ++;
-		if (child)
-			childLast->next = n;
-		else
-			child = n;
-		childLast = n;
-
-		return this;
+		sfCompactNode n;
+		n.m_pNodes = m_pNodes;
+		n.m_pStrings = m_pStrings;
+		n.m_nIndex = index;
+		return n;
 	}
 
-	// ýڵ
-	sfNode* name(const char* name, size_t len = 0)
+	// sfjson::printMembersͨúķʲԣڵ±ʾ
+	class Nodes
 	{
-		if (name)
+	public:
+		typedef uint32_t Ref;
+		const sfCompactNodeBase		*nodes;
+		const char					*strings;
+
+		inline Nodes(const sfCompactNode& n) : nodes(n.m_pNodes), strings(n.m_pStrings) {}
+
+		inline uint32_t type(Ref i) const { return nodes[i].nodeType; }
+		inline Ref child(Ref i) const { return nodes[i].count ? nodes[i].child : 0; }
+		inline Ref next(Ref i, bool) const { return nodes[i].next; }
+		inline const char* name(Ref i, size_t& len) const
 		{
-			sfjson::JFile* p = (sfjson::JFile*)pFile;
-			nameLength = len ? len : strlen(name);
-			nameKey = p->m_strBuf.addString(name, nameLength + 1);
-			nameKey[nameLength] = 0;
+			const char* p = strings + nodes[i].name;
+			uint32_t l;
+			memcpy(&l, p, 4);
+			len = l;
+			return p + 4;
 		}
+		inline const char* string(Ref i, size_t& len) const { len = nodes[i].count; return strings + nodes[i].str; }
+		inline bool boolean(Ref i) const { return nodes[i].bval; }
+		inline int64_t integer(Ref i) const { return nodes[i].ival; }
+		inline double number(Ref i) const { return nodes[i].dval; }
+	};
+};
 
-		return this;
+class sfJsonCompact
+{
+public:
+	inline sfJsonCompact()
+		: m_pNodes(NULL), m_nNodes(0), m_nNodesSize(0)
+		, m_pStrings(NULL), m_nStrings(0), m_nStringsSize(0)
+		, m_pError(NULL)
+	{}
+	~sfJsonCompact()
+	{
+		if (m_pNodes)
+			sfjson::memFree(m_pNodes);
+		if (m_pStrings)
+			sfjson::memFree(m_pStrings);
 	}
 
-	// ñڵֵΪ
-	sfNode* val(bool val)
+	// 룬֮ǰݻᱻsfJsonDecodeһĬcodeԭؽ루޸codebCopyCodeΪtrueʱȸһ
+	bool decode(const char* code, size_t len, bool bCopyCode = false)
 	{
-		assert(nodeType < JATObject);
+		m_nNodes = m_nStrings = 0;
+		m_pError = NULL;
 
-		if (nodeType < JATObject)
+		// Դ볤ȹʼСʱٰ2ַĿͷһַƫ0ʾû
+		if (!reserveNodes(len / 16 + 16) || !reserveStrings(len / 2 + 64))
+			return false;
+		memset(m_pStrings, 0, 5);
+		m_nStrings = 5;
+
+		char* pCode = const_cast<char*>(code);
+		if (bCopyCode)
 		{
-			bval = val;
-			valLength = -1;
-			nodeType = JATBooleanValue;
+			pCode = (char*)sfjson::memAlloc(len + 1);
+			memcpy(pCode, code, len);
+			pCode[len] = 0;
 		}
-		return this;
-	}
-	// ñڵֵΪ
-	sfNode* val(int64_t val)
-	{
-		assert(nodeType < JATObject);
 
-		if (nodeType < JATObject)
+		sfjson::JFile f(len);
+		Builder builder(this);
+		bool r = f.parseSax(pCode, builder) > 0;
+
+		if (bCopyCode)
+			sfjson::memFree(pCode);
+
+		if (!r)
 		{
-			ival = val;
-			valLength = -1;
-			nodeType = JATIntValue;
+			m_nNodes = 0;
+			m_pError = builder.m_bNoMemory ? "out of memory" : f.getError();
 		}
-		return this;
+		return r;
 	}
-	sfNode* val(int val)
+	inline bool decode(const std::string& strInput)
 	{
-		assert(nodeType < JATObject);
+		return decode(strInput.c_str(), strInput.length(), true);
+	}
 
-		if (nodeType < JATObject)
+	sfCompactNode root() const
+	{
+		sfCompactNode n;
+		if (m_nNodes)
 		{
-			ival = val;
-			valLength = -1;
-			nodeType = JATIntValue;
+			n.m_pNodes = m_pNodes;
+			n.m_pStrings = m_pStrings;
 		}
-		return this;
+		return n;
 	}
-	// ñڵֵΪС
-	sfNode* val(double val)
+
+	inline const char* getError() const { return m_pError; }
+	// ڵռõڴֽڵַ壩
+	inline size_t nodesCount() const { return m_nNodes; }
+	inline size_t memoryUsed() const { return m_nNodes * sizeof(sfCompactNodeBase) + m_nStrings; }
+
+private:
+	sfJsonCompact(const sfJsonCompact&);
+	sfJsonCompact& operator = (const sfJsonCompact&);
+
+	sfCompactNodeBase	*m_pNodes;
+	size_t				m_nNodes, m_nNodesSize;
+	char				*m_pStrings;
+	size_t				m_nStrings, m_nStringsSize;
+	const char			*m_pError;
+
+	bool reserveNodes(size_t cc)
 	{
-		assert(nodeType < JATObject);
+		if (m_nNodes + cc <= m_nNodesSize)
+			return true;
+
+		// ±32λ
+		size_t newSize = std::max(m_nNodesSize * 2, m_nNodes + cc);
+		if (newSize > 0xFFFFFFFF)
+			newSize = 0xFFFFFFFF;
+		if (m_nNodes + cc > newSize)
+			return false;
+
+		sfCompactNodeBase* p = (sfCompactNodeBase*)sfjson::memRealloc(m_pNodes, newSize * sizeof(sfCompactNodeBase));
+		if (!p)
+			return false;
+
+		m_pNodes = p;
+		m_nNodesSize = newSize;
+		return true;
+	}
+	bool reserveStrings(size_t len)
+	{
+		if (m_nStrings + len <= m_nStringsSize)
+			return true;
+
+		// ƫ32λ
+		size_t newSize = std::max(m_nStringsSize * 2, m_nStrings + len);
+		if (newSize > 0xFFFFFFFF)
+			newSize = 0xFFFFFFFF;
+		if (m_nStrings + len > newSize)
+			return false;
+
+		char* p = (char*)sfjson::memRealloc(m_pStrings, newSize);
+		if (!p)
+			return false;
+
+		m_pStrings = p;
+		m_nStringsSize = newSize;
+		return true;
+	}
 
-		if (nodeType < JATObject)
+	// SAXʽʱڵhandlerڵ·䣬ֻ±
+	class Builder
+	{
+	public:
+		bool			m_bNoMemory;
+
+		inline Builder(sfJsonCompact* pDoc) : m_bNoMemory(false), m_pDoc(pDoc), m_nName(0), m_nOpens(0) {}
+
+		inline bool onStartObject() { return startNode(JATObject); }
+		inline bool onEndObject(size_t) { m_nOpens --; return true; }
+		inline bool onStartArray() { return startNode(JATArray); }
+		inline bool onEndArray(size_t) { m_nOpens --; return true; }
+
+		inline bool onKey(const char* str, size_t len)
 		{
-			dval = val;
-			valLength = -1;
-			nodeType = JATDoubleValue;
+			m_nName = addString(str, len, true);
+			return m_nName != 0;
 		}
-		return this;
-	}
-	// ñڵֵΪֵַ͡Ϊnullڵ
-	sfNode* val(const char* val = NULL, size_t len = 0)
-	{
-		assert(nodeType < JATObject);
+		inline bool onString(const char* str, size_t len)
+		{
+			uint32_t offset = addString(str, len, false);
+			if (!offset)
+				return false;
+
+			sfCompactNodeBase* n = newNode(JATString);
+			if (!n)
+				return false;
+			n->str = offset;
+			n->count = (uint32_t)len;
+			return true;
+		}
+		inline bool onInt64(int64_t val)
+		{
+			sfCompactNodeBase* n = newNode(JATIntValue);
+			if (n)
+				n->ival = val;
+			return n != NULL;
+		}
+		inline bool onDouble(double val)
+		{
+			sfCompactNodeBase* n = newNode(JATDoubleValue);
+			if (n)
+				n->dval = val;
+			return n != NULL;
+		}
+		inline bool onBool(bool val)
+		{
+			sfCompactNodeBase* n = newNode(JATBooleanValue);
+			if (n)
+				n->bval = val;
+			return n != NULL;
+		}
+		inline bool onNull() { return newNode(JATNullValue) != NULL; }
 
-		if (nodeType < JATObject)
+	private:
+		sfJsonCompact	*m_pDoc;
+		uint32_t		m_nName;
+		uint32_t		m_nOpens;
+		uint32_t		m_opens[SFJ_MAX_PARSE_LEVEL];
+		uint32_t		m_lasts[SFJ_MAX_PARSE_LEVEL];
+
+		// һڵ㲢ӵǰεӽڵĩβصָһδڵǰЧ
+		sfCompactNodeBase* newNode(uint32_t kAttr)
 		{
-			sfjson::JFile* p = (sfjson::JFile*)pFile;
-			if (val)
-			{
-				nodeType = JATString;
-				valLength = len ? len : strlen(val);
-				strval = p->m_strBuf.addString(val, valLength + 1);
-				strval[valLength] = 0;
-			}
-			else
+			sfJsonCompact* p = m_pDoc;
+			if (!p->reserveNodes(1))
 			{
-				strval = NULL;
-				valLength = -1;
-				nodeType = JATNullValue;
+				m_bNoMemory = true;
+				return NULL;
 			}
-		}
-		return this;
-	}
 
-	// Сתͣͷ0
-	inline double toDouble() const
-	{
-		if (nodeType == JATDoubleValue)
-			return dval;
-		if (nodeType == JATIntValue || nodeType == JATBooleanValue)
-			return ival;
-		return 0;
-	}
-	// Сתͣͷ0
-	inline int64_t toInteger() const
-	{
-#define D2I_ENDIALOC	0
+			uint32_t index = (uint32_t)p->m_nNodes ++;
+			sfCompactNodeBase* n = p->m_pNodes + index;
+			memset(n, 0, sizeof(sfCompactNodeBase));
+			n->nodeType = kAttr;
+			n->name = m_nName;
+			m_nName = 0;
 
-		if (nodeType == JATIntValue || nodeType == JATBooleanValue)
-			return ival;
-		if (nodeType == JATDoubleValue)
-		{
-			union d2int
+			if (m_nOpens)
 			{
-				double	dval;
-				int32_t	i32[2];
-			} u;
+				sfCompactNodeBase* parent = p->m_pNodes + m_opens[m_nOpens - 1];
+				if (parent->count ++)
+					p->m_pNodes[m_lasts[m_nOpens - 1]].next = index;
+				else
+					parent->child = index;
+				m_lasts[m_nOpens - 1] = index;
+			}
 
-			u.dval = dval + 6755399441055744.0;
-			return u.i32[D2I_ENDIALOC];
+			return n;
 		}
-		return 0;
-	}
-	// תַ
-	void toString(std::string& strOut) const
-	{
-		size_t len;
-		char szBuf[32];
-
-		switch (nodeType)
+		inline bool startNode(uint32_t kAttr)
 		{
-		case JATString:
-			strOut.append(strval, valLength);
-			break;
-
-		case JATBooleanValue:
-			if (bval)
-				strOut.append("true", 4);
-			else
-				strOut.append("false", 5);
-			break;
-
-		case JATIntValue:
-#ifdef _SFJSON_CRTOPT_H__
-			len = opt_i64toa(ival, szBuf);
-#else
-			len = sprintf(szBuf, "%lld", ival);
-#endif
-			strOut.append(szBuf, len);
-			break;
+			if (!newNode(kAttr))
+				return false;
+			m_opens[m_nOpens ++] = (uint32_t)m_pDoc->m_nNodes - 1;
+			return true;
+		}
+		// ǰ4ֽڵĳȣֵַĳȱڽڵСƫƣʧʱ0
+		uint32_t addString(const char* str, size_t len, bool bWithLength)
+		{
+			sfJsonCompact* p = m_pDoc;
+			if (len > 0xFFFFFFF0 || !p->reserveStrings(len + 5))
+			{
+				m_bNoMemory = true;
+				return 0;
+			}
 
-		case JATDoubleValue:
-#ifdef _SFJSON_CRTOPT_H__
-			len = opt_dtoa(dval, szBuf);
-#else
-			len = sprintf(szBuf, "%f", dval);
-#endif
-			strOut.append(szBuf, len);
-			break;
+			uint32_t offset = (uint32_t)p->m_nStrings;
+			char* dst = p->m_pStrings + offset;
+			if (bWithLength)
+			{
+				uint32_t l = (uint32_t)len;
+				memcpy(dst, &l, 4);
+				dst += 4;
+				p->m_nStrings += 4;
+			}
 
-		case JATNullValue:
-			strOut.append("null", 4);
-			break;
+			memcpy(dst, str, len);
+			dst[len] = 0;
+			p->m_nStrings += len + 1;
+
+			return offset;
 		}
-	}
+	};
+};
 
-	// ֱӻȡС
-	template <typename R> R toInt() const
-	{
-		return (R)ival;
-	}
+//////////////////////////////////////////////////////////////////////////
+// ڵڱ
+static sfNode* sfJsonCreate(bool bIsObject, size_t initMemSize = SFJ_ENCODE_INIT_MEMSIZE)
+{
+	sfjson::JFile* p = (sfjson::JFile*)sfjson::memAlloc(std::max(256, SFJ_ENCODE_INIT_MEMSIZE) + sizeof(sfjson::JFile));
+	new (p) sfjson::JFile((char*)(p + 1), std::max(256, SFJ_ENCODE_INIT_MEMSIZE));
 
-	// ʽΪַ
-	inline bool printTo(std::string& strOut, uint32_t flags = kJsonUnicodes)
+	return p->newRoot(bIsObject);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// ʽ룺ڵ˳beginObject/key/value/endObjectֱд뻺壬sfNode::printToĸʽͬ
+// flushصʱеݴﵽflushSize󽻸صջ壨ڴ汣ȫprintToȡ
+// ˳󣨱ûдkeyendbeginƥ䣩ʱ¼֮ĵö
+class sfJsonWriter
+{
+public:
+	sfJsonWriter(uint32_t flags = kJsonUnicodes, sfNode::fndefNodePrinted fnFlush = NULL, void* user = NULL, size_t flushSize = 65536)
+		: m_fnFlush(fnFlush)
+		, m_pUser(user)
+		, m_nFlushSize(flushSize)
+		, m_nFlags(flags)
 	{
-		return printTo(fnNodePrintToString, &strOut, flags);
+		m_buf.wrapNode(m_fixbuf, sizeof(m_fixbuf));
+		reset();
 	}
 
-	bool printTo(fndefNodePrinted fn, void* user, uint32_t flags = kJsonUnicodes)
+	// е״̬ڴ汣֮дһĵ
+	void reset()
 	{
-		char fixbuf[SFJ_ENCODE_INIT_MEMSIZE];
-		sfjson::JFile* p = (sfjson::JFile*)pFile;
-		sfjson::MemList encodeBuf;
-		char beginChar;
-
-		switch (nodeType)
-		{
-		case JATObject: beginChar = '{'; break;
-		case JATArray: beginChar = '['; break;
-		default: return false;
-		}
+		m_buf.reset();
+		m_pLastChecked = m_buf.first;
+		m_nFlushed = 0;
+		m_nDepth = 0;
+		m_bComma = m_bKey = false;
+		m_pError = NULL;
+	}
 
-		encodeBuf.wrapNode(fixbuf, sizeof(fixbuf));
+	sfJsonWriter& beginObject() { return begin('{'); }
+	sfJsonWriter& beginArray() { return begin('['); }
+	sfJsonWriter& endObject() { return end('{'); }
+	sfJsonWriter& endArray() { return end('['); }
 
-		sfNode* node = child;
-		while (node)
+	// е֣һֵbeginObject/beginArray
+	sfJsonWriter& key(const char* name, size_t len = 0)
+	{
+		if (m_pError)
+			return *this;
+		if (!m_nDepth || !m_bObjects[m_nDepth - 1] || m_bKey)
 		{
-			if (node != child)
-				encodeBuf.addChar(',');
-			p->printToBuffer(encodeBuf, node, this, flags);
-			node = node->next;
+			m_pError = "unexpected key";
+			return *this;
 		}
 
-		// ͳ
-		size_t total = 0;
-		sfjson::MemNode* n = encodeBuf.first;
+		if (!len)
+			len = strlen(name);
 
-		while (n)
+		// ־Ҫת壬ʱͬšźðһд
+		if (sfjson::findEscapeCandidate(name, len) == len)
 		{
-			total += n->used;
-			n = n->next;
+			char* dst = m_buf.reserve(len + 3 + m_bComma);
+			if (m_bComma)
+				*dst ++ = ',';
+			dst[0] = '"';
+			memcpy(dst + 1, name, len);
+			dst[len + 1] = '"';
+			dst[len + 2] = ':';
 		}
-
-		if (fn)
+		else
 		{
-			fn(NULL, total + 2, user);
-			fn(&beginChar, 1, user);
-
-			// ϲ
-			n = encodeBuf.first;
-			while (n)
-			{
-				fn((char*)(n + 1), n->used, user);
-				n = n->next;
-			}
-
-			beginChar = beginChar == '{' ? '}' : ']';
-			fn(&beginChar, 1, user);
+			if (m_bComma)
+				m_buf.addChar(',');
+			m_buf.addChar('"');
+			m_buf.escapeString(name, len, m_nFlags);
+			m_buf.addChar2('"', ':');
 		}
+		m_bKey = true;
 
-		return true;
+		return *this;
 	}
+	inline sfJsonWriter& key(const std::string& name) { return key(name.c_str(), name.length()); }
 
-	// 
-	void destroy()
+	sfJsonWriter& value(bool val)
 	{
-		if (pFile)
+		if (beforeValue())
 		{
-			sfjson::JFile* p = (sfjson::JFile*)pFile;
-			p->~JFile();
-			free(p);
+			if (val)
+				memcpy(m_buf.reserve(4), "true", 4);
+			else
+				memcpy(m_buf.reserve(5), "false", 5);
+			afterValue();
 		}
+		return *this;
 	}
-
-public:// ʽ
-	   // ֵͽڵͬʱΪӽڵ㲢رڵ㣨Ǹմӽڵ㣩
-	inline sfNode* append(bool val)
-	{
-		addValue()->val(val);
-		return this;
-	}
-	// ֵͽڵͬʱΪӽڵ㲢رڵ㣨Ǹմӽڵ㣩
-	inline sfNode* append(int64_t val)
-	{
-		addValue()->val(val);
-		return this;
-	}
-	inline sfNode* append(int val)
+	sfJsonWriter& value(int64_t val)
 	{
-		addValue()->val(val);
-		return this;
+		if (beforeValue())
+		{
+#ifdef _SFJSON_CRTOPT_H__
+			// ֱӸʽ뻺УౣĲٻȥ
+			char* dst = m_buf.reserve(32);
+			m_buf.last->used -= 32 - opt_i64toa(val, dst);
+#else
+			char szBuf[32];
+			size_t len = sprintf(szBuf, "%lld", (long long)val);
+			memcpy(m_buf.reserve(len), szBuf, len);
+#endif
+			afterValue();
+		}
+		return *this;
 	}
-	// ֵͽڵͬʱΪӽڵ㲢رڵ㣨Ǹմӽڵ㣩
-	inline sfNode* append(double val)
+	inline sfJsonWriter& value(int val) { return value((int64_t)val); }
+	sfJsonWriter& value(double val)
 	{
-		addValue()->val(val);
-		return this;
+		if (beforeValue())
+		{
+#ifdef _SFJSON_CRTOPT_H__
+			// ֱӸʽ뻺УౣĲٻȥ
+			char* dst = m_buf.reserve(32);
+			m_buf.last->used -= 32 - opt_dtoa(val, dst);
+#else
+			char szBuf[32];
+			size_t len = sprintf(szBuf, "%f", val);
+			memcpy(m_buf.reserve(len), szBuf, len);
+#endif
+			afterValue();
+		}
+		return *this;
 	}
-	// ֵͽڵͬʱΪӽڵ㲢رڵ㣨Ǹմӽڵ㣩
-	inline sfNode* append(const char* val = NULL, size_t len = 0)
+	// valΪNULLʱnull
+	sfJsonWriter& value(const char* val, size_t len = 0)
 	{
-		addValue()->val(val, len);
-		return this;
-	}
+		if (!val)
+			return null();
 
-	// ֵͽڵͬʱΪӽڵ㲢رڵ㣨Ǹմӽڵ㣩
-	inline sfNode* appendNamed(const char* name, bool val)
-	{
-		addValue()->name(name)->val(val);
-		return this;
-	}
-	// ֵͽڵͬʱΪӽڵ㲢رڵ㣨Ǹմӽڵ㣩
-	inline sfNode* appendNamed(const char* name, int64_t val)
-	{
-		addValue()->name(name)->val(val);
-		return this;
-	}
-	inline sfNode* appendNamed(const char* name, int val)
-	{
-		addValue()->name(name)->val(val);
-		return this;
-	}
-	// ֵͽڵͬʱΪӽڵ㲢رڵ㣨Ǹմӽڵ㣩
-	inline sfNode* appendNamed(const char* name, double val)
-	{
-		addValue()->name(name)->val(val);
-		return this;
-	}
-	// ֵͽڵͬʱΪӽڵ㲢رڵ㣨Ǹմӽڵ㣩
-	inline sfNode* appendNamed(const char* name, const char* val = NULL, size_t len = 0)
-	{
-		addValue()->name(name)->val(val, len);
-		return this;
-	}
+		if (beforeValue())
+		{
+			if (!len)
+				len = strlen(val);
 
-	// ֵ͵Ľڵ
-	inline sfNode* createValue(bool val)
-	{
-		return createValue()->val(val);
+			if (sfjson::findEscapeCandidate(val, len) == len)
+			{
+				char* dst = m_buf.reserve(len + 2);
+				dst[0] = '"';
+				memcpy(dst + 1, val, len);
+				dst[len + 1] = '"';
+			}
+			else
+			{
+				m_buf.addChar('"');
+				m_buf.escapeString(val, len, m_nFlags);
+				m_buf.addChar('"');
+			}
+			afterValue();
+		}
+		return *this;
 	}
-	inline sfNode* createValue(int64_t val)
+	inline sfJsonWriter& value(const std::string& val) { return value(val.c_str(), val.length()); }
+	sfJsonWriter& null()
 	{
-		return createValue()->val(val);
+		if (beforeValue())
+		{
+			memcpy(m_buf.reserve(4), "null", 4);
+			afterValue();
+		}
+		return *this;
 	}
-	inline sfNode* createValue(double val)
+	// Ѿõjsonֵԭд룬κμ
+	sfJsonWriter& raw(const char* json, size_t len)
 	{
-		return createValue()->val(val);
+		if (beforeValue())
+		{
+			m_buf.addString(json, len);
+			afterValue();
+		}
+		return *this;
 	}
-	inline sfNode* createValue(const char* val, size_t len = 0)
+
+	// ѻеȫflushصջ塣ûûصʱʲôҲ
+	void flush()
 	{
-		return createValue()->val(val, len);
+		if (!m_fnFlush)
+			return;
+
+		for (sfjson::MemNode* n = m_buf.first; n; n = n->next)
+		{
+			if (n->used)
+			{
+				m_fnFlush((char*)(n + 1), n->used, m_pUser);
+				m_nFlushed += n->used;
+			}
+			if (n == m_buf.last)
+				break;
+		}
+		m_buf.reset();
+		m_pLastChecked = m_buf.first;
 	}
 
-	// ڵͬʱΪӽڵ㲢ظմĽڵ
-	inline sfNode* addObject(const char* name = NULL, size_t len = 0)
+	// ĵǷѾеĶ鶼Ѿ
+	inline bool isComplete() const { return !m_pError && !m_nDepth && m_bComma; }
+	inline const char* getError() const { return m_pError; }
+
+	// лûнflushصݳȣԼѾصĳ
+	size_t size() const
 	{
-		sfNode* n = createObject(name, len); 
-		add(n);
-		return n;
+		size_t total = 0;
+		for (sfjson::MemNode* n = m_buf.first; n; n = n->next)
+		{
+			total += n->used;
+			if (n == m_buf.last)
+				break;
+		}
+		return total;
 	}
-	// ͬʱΪӽڵ㲢ظմĽڵ
-	inline sfNode* addArray(const char* name = NULL, size_t len = 0)
+	inline size_t flushedSize() const { return m_nFlushed; }
+
+	// ѻе׷ӵstrOutĩβ岻ᱻ
+	void printTo(std::string& strOut) const
 	{
-		sfNode* n = createArray(); 
-		if (name) n->name(name, len);
-		add(n);
-		return n;
+		strOut.reserve(strOut.size() + size());
+		for (sfjson::MemNode* n = m_buf.first; n; n = n->next)
+		{
+			strOut.append((char*)(n + 1), n->used);
+			if (n == m_buf.last)
+				break;
+		}
 	}
 
-	// ֵͬʱΪӽڵ㲢ظմĽڵ
-	inline sfNode* addValue() { sfNode* n = createValue(); add(n); return n; }
-
-	// ֵͬʱΪӽڵ㲢ֵֵ󣬷ظմĽڵ
-	inline sfNode* addValue(bool val) { sfNode* n = createValue()->val(val); add(n); return n; }
-	inline sfNode* addValue(int64_t val) { sfNode* n = createValue()->val(val); add(n); return n; }
-	inline sfNode* addValue(double val) { sfNode* n = createValue()->val(val); add(n); return n; }
-	inline sfNode* addValue(const char* val, size_t len = 0) { sfNode* n = createValue()->val(val, len); add(n); return n; }
-};
+private:
+	sfJsonWriter(const sfJsonWriter&);
+	sfJsonWriter& operator = (const sfJsonWriter&);
 
-//////////////////////////////////////////////////////////////////////////
-// Json
-static sfNode* sfJsonDecode(const char* code, size_t len, bool bCopyCode = false)
-{
-	size_t s = sizeof(sfjson::JFile);
-	if (bCopyCode)
-		s += len;
+	sfJsonWriter& begin(char ch)
+	{
+		if (m_nDepth >= SFJ_MAX_PARSE_LEVEL)
+			m_pError = "too deep";
+		if (!beforeValue())
+			return *this;
 
-	sfjson::JFile* p = (sfjson::JFile*)malloc(s);
-	new (p) sfjson::JFile(len);
+		m_buf.addChar(ch);
+		m_bObjects[m_nDepth ++] = ch == '{';
+		m_bComma = false;
 
-	if (bCopyCode)
-	{
-		memcpy((char*)(p + 1), code, len);
-		if (p->parse(NULL) > 0)
-			return p->getRoot();
+		return *this;
 	}
-	else if (p->parse(const_cast<char*>(code)) > 0)
+	sfJsonWriter& end(char ch)
 	{
-		return p->getRoot();
-	}
-
-	p->~JFile();
-	free(p);
-
-	return NULL;
-}
-static inline sfNode* sfJsonDecode(const std::string& strInput, bool bCopyCode = false)
-{
-	return sfJsonDecode(strInput.c_str(), strInput.length(), bCopyCode);
-}
-
-// ֱʹþַ̬ͬʱٷڴҲٸJsonַ
-#define sfJsonDecl(varname) char varname[sizeof(sfjson::JFile)]
+		if (m_pError)
+			return *this;
+		if (!m_nDepth || m_bObjects[m_nDepth - 1] != (ch == '{') || m_bKey)
+		{
+			m_pError = "unmatched end";
+			return *this;
+		}
 
-static inline sfNode* sfJsonDecodeFixed(void* jFileMem, const char* code, size_t len)
-{
-	sfjson::JFile* p = (sfjson::JFile*)jFileMem;
-	new (p) sfjson::JFile(len);
+		m_buf.addChar(ch == '{' ? '}' : ']');
+		m_nDepth --;
+		afterValue();
 
-	if (p->parse(const_cast<char*>(code)) > 0)
-		return p->getRoot();
+		return *this;
+	}
 
-	return NULL;
-}
-static sfNode* sfJsonDecodeFixed(void* jFileMem, const std::string& strInput)
-{
-	return sfJsonDecodeFixed(jFileMem, strInput.c_str(), strInput.length());
-}
+	// дֵ֮ǰλǷȷ϶
+	bool beforeValue()
+	{
+		if (m_pError)
+			return false;
 
-//////////////////////////////////////////////////////////////////////////
-// ڵڱ
-static sfNode* sfJsonCreate(bool bIsObject, size_t initMemSize = SFJ_ENCODE_INIT_MEMSIZE)
-{
-	sfjson::JFile* p = (sfjson::JFile*)malloc(std::max(256, SFJ_ENCODE_INIT_MEMSIZE) + sizeof(sfjson::JFile));
-	new (p) sfjson::JFile((char*)(p + 1), std::max(256, SFJ_ENCODE_INIT_MEMSIZE));
+		if (m_nDepth && m_bObjects[m_nDepth - 1])
+		{
+			if (!m_bKey)
+			{
+				m_pError = "missing key";
+				return false;
+			}
+			m_bKey = false;
+		}
+		else if (m_bComma)
+		{
+			if (!m_nDepth)
+			{
+				m_pError = "multiple root values";
+				return false;
+			}
+			m_buf.addChar(',');
+		}
+		return true;
+	}
+	// дһֵ󣬻ֶµڴʱһǷҪflush
+	inline void afterValue()
+	{
+		m_bComma = true;
+		if (m_fnFlush && m_buf.last != m_pLastChecked)
+		{
+			m_pLastChecked = m_buf.last;
+			if (size() >= m_nFlushSize)
+				flush();
+		}
+	}
 
-	return p->newRoot(bIsObject);
-}
+	char						m_fixbuf[SFJ_ENCODE_INIT_MEMSIZE];		// ǰ棬֤MemNodeָ
+	sfjson::MemList				m_buf;
+	sfNode::fndefNodePrinted	m_fnFlush;
+	void						*m_pUser;
+	size_t						m_nFlushSize, m_nFlushed;
+	sfjson::MemNode				*m_pLastChecked;
+	const char					*m_pError;
+	uint32_t					m_nFlags, m_nDepth;
+	bool						m_bComma, m_bKey;
+	bool						m_bObjects[SFJ_MAX_PARSE_LEVEL];
+};
 
 #endif
\ No newline at end of file